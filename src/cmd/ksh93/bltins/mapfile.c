@@ -0,0 +1,236 @@
+/***********************************************************************
+ *                                                                      *
+ *               This software is part of the ast package               *
+ *          Copyright (c) 1982-2014 AT&T Intellectual Property          *
+ *                      and is licensed under the                       *
+ *                 Eclipse Public License, Version 1.0                  *
+ *                    by AT&T Intellectual Property                     *
+ *                                                                      *
+ *                A copy of the License is available at                 *
+ *          http://www.eclipse.org/org/documents/epl-v10.html           *
+ *         (with md5 checksum b35adb5213ca9657e911e9befb180842)         *
+ *                                                                      *
+ *              Information and Software Systems Research               *
+ *                            AT&T Research                             *
+ *                           Florham Park NJ                            *
+ *                                                                      *
+ *                    David Korn <dgkorn@gmail.com>                     *
+ *                                                                      *
+ ***********************************************************************/
+//
+// mapfile [-t] [-d delim] [-n count] [-O origin] [-s count] [-u fd] [var]
+//
+#include "config_ast.h"  // IWYU pragma: keep
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "builtins.h"
+#include "defs.h"
+#include "error.h"
+#include "fault.h"
+#include "io.h"
+#include "name.h"
+#include "option.h"
+#include "sfio.h"
+#include "shcmd.h"
+
+#define MAPFILE_BATCH 1024  // lines handed to nv_aistore() at a time
+
+struct mapfile {
+    Namval_t *np;
+    char *part;     // start of a line that continues past the end of the buffer
+    size_t plen;
+    size_t psize;
+    long skip;      // lines still to be discarded
+    long left;      // lines still to be stored, -1 for all of them
+    long sub;       // subscript of vals[0]
+    int delim;
+    bool trim;
+    bool fast;      // nv_aistore() has not refused the array
+    int nvals;
+    char *vals[MAPFILE_BATCH];
+};
+
+//
+// Move the pending lines into the array.
+//
+static_fn void mapfile_flush(struct mapfile *mp) {
+    int i;
+
+    if (mp->nvals == 0) return;
+    if (mp->fast && !nv_aistore(mp->np, mp->sub, mp->nvals, mp->vals)) mp->fast = false;
+    if (!mp->fast) {
+        for (i = 0; i < mp->nvals; i++) {
+            nv_putsub(mp->np, NULL, mp->sub + i, ARRAY_ADD);
+            nv_putval(mp->np, mp->vals[i], 0);
+            free(mp->vals[i]);
+        }
+    }
+    mp->sub += mp->nvals;
+    mp->nvals = 0;
+}
+
+//
+// Add the <n> bytes at <cp>, which end with the delimiter if <delimited> is set, to the line
+// carried over from the previous buffer and store the result.
+//
+static_fn void mapfile_line(struct mapfile *mp, const char *cp, size_t n, bool delimited) {
+    char *val;
+
+    if (mp->skip > 0) {
+        mp->skip--;
+        mp->plen = 0;
+        return;
+    }
+    if (delimited && mp->trim) n--;
+    val = malloc(mp->plen + n + 1);
+    if (mp->plen) memcpy(val, mp->part, mp->plen);
+    memcpy(val + mp->plen, cp, n);
+    val[mp->plen + n] = 0;
+    mp->plen = 0;
+    mp->vals[mp->nvals++] = val;
+    if (mp->left > 0) mp->left--;
+    if (mp->nvals == MAPFILE_BATCH) mapfile_flush(mp);
+}
+
+//
+// Save the <n> bytes at <cp> that begin a line which the next buffer completes.
+//
+static_fn void mapfile_carry(struct mapfile *mp, const char *cp, size_t n) {
+    if (mp->plen + n > mp->psize) {
+        mp->psize = roundof(mp->plen + n, 1024);
+        mp->part = realloc(mp->part, mp->psize);
+    }
+    memcpy(mp->part + mp->plen, cp, n);
+    mp->plen += n;
+}
+
+//
+// Builtin `mapfile` and its alias `readarray`.
+//
+int b_mapfile(int argc, char *argv[], Shbltin_t *context) {
+    Shell_t *shp = context->shp;
+    struct mapfile map;
+    Namarr_t *ap;
+    Sfio_t *iop;
+    char *cp, *start, *end, *ep;
+    const char *name = "MAPFILE";
+    const char *optstr = *argv[0] == 'r' ? sh_optreadarray : sh_optmapfile;
+    long origin = -1, count = 0;
+    int r, fd = 0, jmpval = 0;
+    bool was_share;
+    checkpt_t buff;
+    UNUSED(argc);
+
+    memset(&map, 0, sizeof(map));
+    map.delim = '\n';
+    while ((r = optget(argv, optstr))) {
+        switch (r) {  //!OCLINT(MissingDefaultStatement)
+            case 'd': {
+                map.delim = *(unsigned char *)opt_info.arg;
+                break;
+            }
+            case 'n': {
+                count = opt_info.num;
+                break;
+            }
+            case 'O': {
+                origin = opt_info.num;
+                break;
+            }
+            case 's': {
+                map.skip = opt_info.num;
+                break;
+            }
+            case 't': {
+                map.trim = true;
+                break;
+            }
+            case 'u': {
+                fd = (int)strtol(opt_info.arg, &opt_info.arg, 10);
+                if (*opt_info.arg || !sh_iovalidfd(shp, fd)) fd = -1;
+                break;
+            }
+            case ':': {
+                errormsg(SH_DICT, 2, "%s", opt_info.arg);
+                break;
+            }
+            case '?': {
+                errormsg(SH_DICT, ERROR_usage(2), "%s", opt_info.arg);
+                __builtin_unreachable();
+            }
+        }
+    }
+    argv += opt_info.index;
+    if (error_info.errors || count < 0 || origin < -1 || map.skip < 0 || (*argv && argv[1])) {
+        errormsg(SH_DICT, ERROR_usage(2), "%s", optusage(NULL));
+        __builtin_unreachable();
+    }
+    if (fd >= 0 && (!((r = shp->fdstatus[fd]) & IOREAD) || !(r & (IOSEEK | IONOSEEK)))) {
+        r = sh_iocheckfd(shp, fd, fd);
+    }
+    if (fd < 0 || !(r & IOREAD)) {
+        errormsg(SH_DICT, ERROR_system(1), e_file + 4);
+        __builtin_unreachable();
+    }
+    if (!(iop = shp->sftable[fd]) && !(iop = sh_iostream(shp, fd, fd))) return 1;
+    if (*argv) name = *argv;
+    map.np = nv_open(name, shp->var_tree, NV_ASSIGN | NV_VARNAME);
+    if (shp->subshell) map.np = sh_assignok(map.np, 1);
+    if (origin < 0) {
+        // Clear the array the way `read -A` does.
+        if ((ap = nv_arrayptr(map.np)) && !ap->fun) ap->nelem++;
+        nv_unset(map.np);
+        if ((ap = nv_arrayptr(map.np)) && !ap->fun) ap->nelem--;
+        origin = 0;
+    } else if ((ap = nv_arrayptr(map.np)) && is_associative(ap)) {
+        errormsg(SH_DICT, ERROR_exit(1), "cannot append index array to associative array %s",
+                 nv_name(map.np));
+        __builtin_unreachable();
+    }
+    map.sub = origin;
+    map.left = count ? count : -1;
+    map.fast = true;
+
+    // Lines past the last one wanted must be left unread for the next reader of a shared stream.
+    // When all of them are wanted there is nothing to leave behind.
+    was_share = (sfset(iop, 0, 0) & SF_SHARE) != 0;
+    if (!count) {
+        sfset(iop, SF_SHARE, 0);
+    } else if (sffileno(iop) == 0) {
+        sfset(iop, SF_SHARE, shp->redir0 != 2);
+    }
+    sfclrerr(iop);
+    sh_pushcontext(shp, &buff, 1);
+    jmpval = sigsetjmp(buff.buff, 0);
+    if (jmpval) goto done;
+    while (map.left && (cp = sfreserve(iop, SF_UNBOUND, SF_LOCKR))) {
+        start = cp;
+        end = cp + sfvalue(iop);
+        while (map.left && start < end) {
+            if (!(ep = memchr(start, map.delim, end - start))) {
+                mapfile_carry(&map, start, end - start);
+                start = end;
+                break;
+            }
+            ep++;
+            mapfile_line(&map, start, ep - start, true);
+            start = ep;
+        }
+        sfread(iop, cp, start - cp);
+    }
+    if (map.left && map.plen) mapfile_line(&map, "", 0, false);
+
+done:
+    sh_popcontext(shp, &buff);
+    mapfile_flush(&map);
+    if (map.part) free(map.part);
+    sfset(iop, SF_SHARE, was_share);
+    nv_close(map.np);
+    if (jmpval > 1) siglongjmp(shp->jmplist->buff, jmpval);
+    return jmpval;
+}
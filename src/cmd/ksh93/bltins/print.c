@@ -74,6 +74,10 @@ struct printf {
     char cescape;
     char err;
     Shell_t *sh;
+    char **args;  // the arguments for the format
+    char *split;  // the format cut by splitformat() or NULL
+    char *text;   // the text of <split> before the conversion being done
+    char *tail;   // the text of <split> after the last conversion when it has not been written
 };
 
 struct printmap {
@@ -91,8 +95,28 @@ static const struct printmap Pmap[] = {
 
 static const char preformat[] = "";
 
+//
+// The last few printf formats with their escape sequences expanded. Scripts tend to print many
+// lines with the same few formats.
+//
+#define FMTCACHE_MAX 8
+
+struct fmtcache {
+    char *raw;     // format as given
+    char *format;  // format with the escapes expanded
+    size_t len;
+    char *split;   // format cut by splitformat() or NULL
+    size_t splitlen;
+};
+
+static struct {
+    uint32_t serial;  // ast.locale.serial when the formats were expanded
+    int next;         // entry to replace when all are in use
+    struct fmtcache ent[FMTCACHE_MAX];
+} fmtcache;
+
 static_fn int extend(Sfio_t *, void *, Sffmt_t *);
-static_fn char *genformat(Shell_t *, char *);
+static_fn char *genformat(Shell_t *, char *, char **);
 static_fn int fmtvecho(Shell_t *, const char *, struct printf *);
 static_fn ssize_t fmtbase64(Shell_t *, Sfio_t *, char *, const char *, int);
 
@@ -183,6 +207,7 @@ int b_print(int argc, char *argv[], Shbltin_t *context) {
     char *fmttype = NULL;
     int sflag = 0, nflag = 0, rflag = 0, vflag = 0;
     Namval_t *vname = NULL;
+    char *split = NULL;
     Optdisc_t disc;
 
     memset(&disc, 0, sizeof(disc));
@@ -204,6 +229,12 @@ int b_print(int argc, char *argv[], Shbltin_t *context) {
             goto skip;
         }
     }
+    // The option parser sets itself up again for each printf that has no options. The format
+    // operand can only be an option if it begins with a -.
+    if (argc < 0 && argv[1] && *argv[1] != '-') {
+        opt_info.index = 1;
+        goto operands;
+    }
     while ((n = optget(argv, options))) {
         switch (n) {  //!OCLINT(MissingDefaultStatement)
             case 'n': {
@@ -304,6 +335,7 @@ int b_print(int argc, char *argv[], Shbltin_t *context) {
         }
     }
 
+operands:
     argv += opt_info.index;
     if (error_info.errors || (argc < 0 && !(format = *argv++))) {
         errormsg(SH_DICT, ERROR_usage(2), "%s", optusage(NULL));
@@ -315,7 +347,7 @@ int b_print(int argc, char *argv[], Shbltin_t *context) {
     }
 
 skip:
-    if (format) format = genformat(shp, format);
+    if (format) format = genformat(shp, format, &split);
     // Handle special case of '-' operand for print.
     if (argc > 0 && *argv && strcmp(*argv, "-") == 0 && strcmp(argv[-1], "--")) argv++;
     if (vname) {
@@ -363,11 +395,29 @@ printv:
         pdata.nextarg = argv;
         sh_offstate(shp, SH_STOPOK);
         pool = sfpool(sfstderr, NULL, SF_WRITE);
-        do {
-            if (shp->trapnote & SH_SIGSET) break;
-            pdata.sffmt.form = format;
-            sfprintf(outfile, "%!", &pdata);
-        } while (*pdata.nextarg && pdata.nextarg != argv);
+        if (split) {
+            // sfprintf() is given the conversions one at a time by extend(), which writes the
+            // text between them and goes back to the first one while arguments are left. A format
+            // with no conversions consumes no arguments, so it is output once.
+            pdata.args = argv;
+            pdata.split = pdata.text = split;
+            split += strlen(split) + 1;
+            if (shp->trapnote & SH_SIGSET) {
+                ;
+            } else if (!*split) {
+                sfputr(outfile, pdata.text, -1);
+            } else {
+                pdata.sffmt.form = split;
+                sfprintf(outfile, "%!", &pdata);
+                if (pdata.tail) sfputr(outfile, pdata.tail, -1);
+            }
+        } else {
+            do {
+                if (shp->trapnote & SH_SIGSET) break;
+                pdata.sffmt.form = format;
+                sfprintf(outfile, "%!", &pdata);
+            } while (*pdata.nextarg && pdata.nextarg != argv);
+        }
         if (pdata.nextarg == nullarg && pdata.argsize > 0) {
             sfwrite(outfile, stkptr(shp->stk, stktell(shp->stk)), pdata.argsize);
         }
@@ -434,7 +484,7 @@ int sh_echolist(Shell_t *shp, Sfio_t *outfile, int raw, char *argv[]) {
 //
 // Modified version of stresc for generating formats.
 //
-static_fn char strformat(char *s) {
+static_fn size_t strformat(char *s) {
     char *t;
     int c;
     char *b;
@@ -475,14 +525,104 @@ static_fn char strformat(char *s) {
     }
 }
 
-static_fn char *genformat(Shell_t *shp, char *format) {
-    char *fp;
+//
+// Cut the expanded <format> into text and conversions. Each piece ends with a 0 byte, they
+// alternate starting and ending with text, which can be empty, and the last text is followed by
+// another 0 byte. A %% in the format is text. The length is stored in <size>. NULL is returned
+// for a format that has to be given to sfprintf() whole: one with positional arguments or %n,
+// which counts from the start of the sfprintf() call, or anything else not known here.
+//
+static_fn char *splitformat(const char *format, size_t len, size_t *size) {
+    const char *s = format, *b;
+    char *split = malloc(2 * len + 3), *t = split;
+    int c, n, level;
+
+    while (1) {
+        while ((c = *s)) {
+            if (c == '%') {
+                if (s[1] != '%' && s[1]) break;
+                *t++ = '%';
+                s += s[1] ? 2 : 1;
+                continue;
+            }
+            if ((n = mblen(s, MB_CUR_MAX)) <= 0) n = 1;
+            memcpy(t, s, n);
+            t += n;
+            s += n;
+        }
+        *t++ = 0;
+        if (!c) break;
+        for (b = s++; (c = *s++);) {
+            if (c == '(') {
+                // A (*) takes an argument.
+                if (*s == '*') break;
+                for (level = 1; level && *s; s++) {
+                    if (*s == '(') {
+                        level++;
+                    } else if (*s == ')') {
+                        level--;
+                    }
+                }
+                if (level) break;
+            } else if (!strchr("-0123456789 +=#',.*hljtLzI", c)) {
+                break;
+            }
+        }
+        if (!isalpha(c) || c == 'n') {
+            free(split);
+            return NULL;
+        }
+        memcpy(t, b, s - b);
+        t += s - b;
+        *t++ = 0;
+    }
+    *t++ = 0;
+    *size = t - split;
+    return split;
+}
+
+//
+// Return a copy of <format> on the stack with the escape sequences expanded. <split> is set to a
+// copy of it cut by splitformat() or to NULL.
+//
+static_fn char *genformat(Shell_t *shp, char *format, char **split) {
+    struct fmtcache *fp;
+    int i;
+
+    if (fmtcache.serial != ast.locale.serial) {
+        for (i = 0; i < FMTCACHE_MAX && (fp = &fmtcache.ent[i])->raw; i++) {
+            free(fp->raw);
+            free(fp->format);
+            free(fp->split);
+            fp->raw = NULL;
+        }
+        fmtcache.next = 0;
+        fmtcache.serial = ast.locale.serial;
+    }
+    for (i = 0; i < FMTCACHE_MAX && (fp = &fmtcache.ent[i])->raw; i++) {
+        if (strcmp(fp->raw, format) == 0) break;
+    }
+    if (i == FMTCACHE_MAX || !fp->raw) {
+        if (i == FMTCACHE_MAX) {
+            fp = &fmtcache.ent[fmtcache.next];
+            fmtcache.next = (fmtcache.next + 1) % FMTCACHE_MAX;
+            free(fp->raw);
+            free(fp->format);
+            free(fp->split);
+        }
+        fp->raw = strdup(format);
+        fp->format = strdup(format);
+        fp->len = strformat(fp->format);
+        fp->split = splitformat(fp->format, fp->len, &fp->splitlen);
+    }
     stkseek(shp->stk, 0);
     sfputr(shp->stk, preformat, -1);
-    sfputr(shp->stk, format, -1);
-    fp = (char *)stkfreeze(shp->stk, 1);
-    strformat(fp + sizeof(preformat) - 1);
-    return fp;
+    sfwrite(shp->stk, fp->format, fp->len);
+    format = stkfreeze(shp->stk, 1);
+    // A discipline run by a conversion can run printf and replace this entry, so copies are used.
+    *split = NULL;
+    if (fp->split) *split = memcpy(stkalloc(shp->stk, fp->splitlen), fp->split, fp->splitlen);
+    return format;
 }
 
 static_fn char *fmthtml(Shell_t *shp, const char *string, int flags) {
@@ -662,7 +802,6 @@ static_fn const char *mapformat(Sffmt_t *fe) {
 }
 
 static_fn int extend(Sfio_t *sp, void *v, Sffmt_t *fe) {
-    UNUSED(sp);
     char *lastchar = "";
     Sfdouble_t d;
     Sfdouble_t longmin = LDBL_LLONG_MIN;
@@ -675,6 +814,20 @@ static_fn int extend(Sfio_t *sp, void *v, Sffmt_t *fe) {
     Shell_t *shp = pp->sh;
     char *argp = *pp->nextarg;
     char *w, *s;
+    char *next = NULL;
+
+    // Write the text of a split format that comes before this conversion. A * in the conversion
+    // is asked for as a '.' or an 'I' and is not a conversion of its own.
+    if (pp->split && format != '.' && format != 'I') {
+        if (pp->tail) {
+            sfputr(sp, pp->tail, -1);
+            pp->tail = NULL;
+        }
+        n = strlen(pp->text);
+        sfwrite(sp, pp->text, n);
+        next = pp->text + n + 1;
+        next += strlen(next) + 1;
+    }
 
     if (fe->n_str > 0 && (format == 'T' || format == 'Q') && varname(fe->t_str, fe->n_str) &&
         (!argp || varname(argp, -1))) {
@@ -1027,6 +1180,21 @@ static_fn int extend(Sfio_t *sp, void *v, Sffmt_t *fe) {
         }
         default: { break; }
     }
+    if (next) {
+        // Go on with the next conversion, or with the first one when this was the last and there
+        // are arguments left. The text after the last conversion is written before the next
+        // one is done, or by the caller.
+        pp->text = next;
+        if (*(next + strlen(next) + 1)) {
+            fe->form = next + strlen(next) + 1;
+        } else {
+            pp->tail = next;
+            pp->text = pp->split;
+            if (*pp->nextarg && pp->nextarg != pp->args && !(shp->trapnote & SH_SIGSET)) {
+                fe->form = pp->split + strlen(pp->split) + 1;
+            }
+        }
+    }
     return 0;
 }
 
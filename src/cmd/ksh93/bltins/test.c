@@ -92,6 +92,27 @@ struct test {
     char **av;
 };
 
+//
+// The status of the last few files looked at by the operators of one test expression, so that
+// `[[ -f $f && -s $f ]]` does a single stat(). It is only used between test_remember() and
+// test_forget(), which sh_exec() calls before running anything that could change the files.
+//
+#define STATMEMO_MAX 4
+
+struct statmemo {
+    char *name;
+    size_t size;  // bytes allocated for name
+    int err;      // errno when the stat failed
+    struct stat statb;
+};
+
+static struct {
+    bool on;
+    int n;     // entries in use
+    int next;  // entry to replace when all are in use
+    struct statmemo ent[STATMEMO_MAX];
+} memo;
+
 static_fn char *nxtarg(struct test *, int);
 static_fn int eval_expr(Shell_t *shp, struct test *, int);
 static_fn int eval_e3(Shell_t *shp, struct test *);
@@ -132,6 +153,7 @@ int b_test(int argc, char *argv[], Shbltin_t *context) {
 
     sh_pushcontext(shp, &buff, 1);
     jmpval = sigsetjmp(buff.buff, 0);
+    test_remember();
 
     // According to POSIX, test builtin should always return value > 1 on error
     if (jmpval) {
@@ -217,6 +239,7 @@ int b_test(int argc, char *argv[], Shbltin_t *context) {
     result = !eval_expr(shp, &tdata, 0);
 
 done:
+    test_forget();
     sh_popcontext(shp, &buff);
     return result;
 }
@@ -406,6 +429,12 @@ int test_unop(Shell_t *shp, int op, const char *arg) {
         case 'a':
         case 'e': {
             if (strncmp(arg, "/dev/", 5) == 0 && sh_open(arg, O_NONBLOCK)) return 1;
+            // A file that can be stat()ed exists, and the status can be shared with the other
+            // operators. Otherwise the ids are swapped as for the other access checks.
+            if (memo.on && shp->gd->userid == shp->gd->euserid &&
+                shp->gd->groupid == shp->gd->egroupid && !sh_isdevfd(arg)) {
+                return test_stat(arg, &statb) >= 0;
+            }
             return permission(arg, F_OK);
         }
         case 'o': {
@@ -665,14 +694,66 @@ static_fn int test_mode(const char *file) {
     return statb.st_mode;
 }
 
+//
+// Start remembering the status of the files that are tested.
+//
+void test_remember(void) { memo.on = true; }
+
+//
+// Stop remembering file status and drop what was remembered.
+//
+void test_forget(void) {
+    if (!memo.on) return;
+    memo.on = false;
+    memo.n = 0;
+}
+
 /*
  * do an fstat() for /dev/fd/n, otherwise stat()
  */
 static_fn int test_stat(const char *name, struct stat *buff) {
+    struct statmemo *mp;
+    size_t len;
+    int i, r;
+
     if (*name == 0) {
         errno = ENOENT;
         return -1;
     }
-    if (sh_isdevfd(name)) return fstat((int)strtol(name + 8, NULL, 10), buff);
-    return sh_stat(name, buff);
+    if (memo.on) {
+        for (i = 0; i < memo.n; i++) {
+            mp = &memo.ent[i];
+            if (strcmp(mp->name, name) == 0) {
+                if (mp->err) {
+                    errno = mp->err;
+                    return -1;
+                }
+                *buff = mp->statb;
+                return 0;
+            }
+        }
+    }
+    if (sh_isdevfd(name)) {
+        r = fstat((int)strtol(name + 8, NULL, 10), buff);
+    } else {
+        r = sh_stat(name, buff);
+    }
+    if (memo.on && (r == 0 || errno != EINTR)) {
+        if (memo.n < STATMEMO_MAX) {
+            mp = &memo.ent[memo.n++];
+        } else {
+            mp = &memo.ent[memo.next];
+            memo.next = (memo.next + 1) % STATMEMO_MAX;
+        }
+        len = strlen(name) + 1;
+        if (len > mp->size) {
+            free(mp->name);
+            mp->size = roundof(len, 64);
+            mp->name = malloc(mp->size);
+        }
+        memcpy(mp->name, name, len);
+        mp->err = r < 0 ? errno : 0;
+        if (r == 0) mp->statb = *buff;
+    }
+    return r;
 }
@@ -193,7 +193,10 @@ int b_alias(int argc, char *argv[], Shbltin_t *context) {
     }
 
     argv += (opt_info.index - 1);
-    if (!nv_isflag(nvflags, NV_TAGGED)) return setall(argv, nvflags, troot, &tdata);
+    if (!nv_isflag(nvflags, NV_TAGGED)) {
+        if (argv[1]) tdata.sh->aliasgen++;
+        return setall(argv, nvflags, troot, &tdata);
+    }
 
     // Hacks to handle hash -r | --.
     if (argv[1] && argv[1][0] == '-') {
@@ -780,6 +783,8 @@ static_fn int setall(char **argv, nvflag_t flag, Dt_t *troot, struct tdata *tp)
                 cp = (char *)nv_mapchar(np, NULL);
                 fp = nv_mapchar(np, tp->wctname);
                 if (fp) {
+                    // Save the variable before its disciplines change.
+                    if (shp->subshell) sh_assignok(np, 1);
                     if (tp->aflag == '+') {
                         if (cp && strcmp(cp, tp->wctname) == 0) {
                             nv_disc(np, fp, DISC_OP_POP);
@@ -894,6 +899,7 @@ typedef struct Libcomp_s {
     dev_t dev;
     ino_t ino;
     nvflag_t attr;
+    Dt_t *syms;  // b_* symbols looked up so far, with a null address for those not exported
 } Libcomp_t;
 
 static Libcomp_t *liblist = NULL;
@@ -916,12 +922,14 @@ int sh_addlib(Shell_t *shp, void *dll, char *name, Pathcomp_t *pp) {
     int r;
     Libinit_f initfn;
     Shbltin_t *sp = &shp->bltindata;
+    Dt_t *syms = NULL;
 
     sp->nosfio = 0;
     for (n = r = 0; n < nlib; n++) {
         if (r) {
             liblist[n - 1] = liblist[n];
         } else if (liblist[n].dll == dll) {
+            syms = liblist[n].syms;
             r++;
         }
     }
@@ -940,18 +948,42 @@ int sh_addlib(Shell_t *shp, void *dll, char *name, Pathcomp_t *pp) {
     if (pp) {
         liblist[nlib].dev = pp->dev;
         liblist[nlib].ino = pp->ino;
+    } else {
+        liblist[nlib].dev = 0;
+        liblist[nlib].ino = 0;
     }
+    liblist[nlib].syms = syms;
     nlib++;
     return !r;
 }
 
+//
+// Return the address of builtin <sym> in library <lp>. A library is never unloaded so what it
+// exports does not change; the answer, including that there is no such symbol, is kept in the
+// library's symbol index and each name costs at most one dlsym() no matter how often it is asked
+// for.
+//
+static_fn Shbltin_f lib_lookup(Libcomp_t *lp, const char *sym) {
+    Namval_t *np;
+
+    if (!lp->syms) lp->syms = dtopen(&_Nvdisc, Dtset);
+    if ((np = nv_search(sym, lp->syms, 0))) {
+        sh_stats(STAT_BLTINHITS);
+    } else {
+        sh_stats(STAT_BLTINMISSES);
+        np = nv_search(sym, lp->syms, NV_ADD);
+        STORE_VT(np->nvalue, shbltinp, (Shbltin_f)dlllook(lp->dll, sym));
+    }
+    return FETCH_VT(np->nvalue, shbltinp);
+}
+
 Shbltin_f sh_getlib(Shell_t *shp, char *sym, Pathcomp_t *pp) {
     UNUSED(shp);
     int n;
 
     for (n = 0; n < nlib; n++) {
         if (liblist[n].ino == pp->ino && liblist[n].dev == pp->dev) {
-            return (Shbltin_f)dlllook(liblist[n].dll, sym);
+            return lib_lookup(&liblist[n], sym);
         }
     }
     return 0;
@@ -1074,7 +1106,7 @@ int b_builtin(int argc, char *argv[], Shbltin_t *context) {
         if (disable || nlib) {
             for (n = (nlib ? nlib : disable ? 1 : 0); --n >= 0;) {
                 if (!disable && !liblist[n].dll) continue;
-                if (disable || (addr = (Shbltin_f)dlllook(liblist[n].dll, stkptr(stkp, stkoff)))) {
+                if (disable || (addr = lib_lookup(&liblist[n], stkptr(stkp, stkoff)))) {
                     np = sh_addbuiltin(tdata.sh, arg, addr, disable);
                     if (np) {
                         if (disable || nv_isattr(np, BLT_SPC)) {
@@ -1164,6 +1196,7 @@ static_fn int unall(int argc, char **argv, Dt_t *troot, Shell_t *shp) {
     if (troot == shp->alias_tree) {
         type = ALIAS;
         name = sh_optunalias;
+        shp->aliasgen++;
         if (shp->subshell) troot = sh_subaliastree(shp, 0);
     } else {
         type = VARIABLE;
@@ -19,12 +19,14 @@
  ***********************************************************************/
 #include "config_ast.h"  // IWYU pragma: keep
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 #include "builtins.h"
 #include "defs.h"
 #include "error.h"
 #include "jobs.h"
+#include "name.h"
 #include "option.h"
 #include "shcmd.h"
 
@@ -33,8 +35,20 @@
 //
 int b_wait(int n, char *argv[], Shbltin_t *context) {
     Shell_t *shp = context->shp;
+    Namval_t *np = NULL;
+    bool any = false;
+    pid_t pid;
+
     while ((n = optget(argv, sh_optwait))) {
         switch (n) {  //!OCLINT(MissingDefaultStatement)
+            case 'n': {
+                any = true;
+                break;
+            }
+            case 'p': {
+                np = nv_open(opt_info.arg, shp->var_tree, NV_VARNAME);
+                break;
+            }
             case ':': {
                 errormsg(SH_DICT, 2, "%s", opt_info.arg);
                 break;
@@ -52,6 +66,18 @@ int b_wait(int n, char *argv[], Shbltin_t *context) {
     }
 
     argv += opt_info.index;
-    job_bwait(argv);
+    pid = job_bwait(argv, any);
+    if (np) {
+        if (pid) {
+#if SHOPT_COSHELL
+            nv_putval(np, sh_pid2str(shp, pid), 0);
+#else
+            nv_putval(np, fmtbase(pid, 0, 0), 0);
+#endif  // SHOPT_COSHELL
+        } else {
+            nv_unset(np);
+        }
+        nv_close(np);
+    }
     return shp->exitval;
 }
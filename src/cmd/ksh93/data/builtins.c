@@ -102,7 +102,9 @@ const struct shtable3 shtab_builtins[] = {
     {"print", NV_BLTIN | BLT_ENV, bltin(print)},
     {"printf", NV_BLTIN | BLT_ENV, bltin(printf)},
     {"pwd", NV_BLTIN, bltin(pwd)},
+    {"mapfile", NV_BLTIN | BLT_ENV, bltin(mapfile)},
     {"read", NV_BLTIN | BLT_ENV, bltin(read)},
+    {"readarray", NV_BLTIN | BLT_ENV, bltin(mapfile)},
     {"sleep", NV_BLTIN, bltin(sleep)},
     {"ulimit", NV_BLTIN | BLT_ENV, bltin(ulimit)},
     {"umask", NV_BLTIN | BLT_ENV, bltin(umask)},
@@ -168,8 +170,10 @@ const char sh_set[] =
     "[++?contained in the pipeline following \b!\b.]"
     "}"
     "[f?Pathname expansion is disabled.]"
-    "[h?Obsolete.  Causes each command whose name has the syntax of an "
-    "alias to become a tracked alias when it is first encountered.]"
+    "[h?Causes each command whose name has the syntax of an "
+    "alias to become a tracked alias when it is first encountered. "
+    "The names in \bPATH\b directories that are searched repeatedly "
+    "are remembered until the directory is modified.]"
     "[k?This is obsolete.  All arguments of the form \aname\a\b=\b\avalue\a "
     "are removed and placed in the variable assignment list for "
     "the command.  Ordinarily, variable assignments must precede "
@@ -995,6 +999,42 @@ const char sh_optlet[] = "[-1c?@(#)$Id: let (AT&T Research) 2000-04-02 $\n]" USA
                          "}"
                          "[+SEE ALSO?\bexpr\b(1), \btest\b(1), \bksh\b(1)]";
 
+#define _MAPFILE_                                                                        \
+    "[+?If \avar\a is omitted, the array \bMAPFILE\b is used.  Unless \b-O\b is "        \
+    "specified, \avar\a is unset before any lines are read.  The lines are stored "      \
+    "as they are read, including the delimiter, with no field splitting or "             \
+    "backslash processing.  A final line without a delimiter is also stored.]"           \
+    "[+?\bmapfile\b and \breadarray\b are the same command.]"                            \
+    "[d]:[delim?Use the first byte of \adelim\a to terminate each line instead of "      \
+    "new-line.  If \adelim\a is the empty string, lines are terminated by a null byte.]" \
+    "[n]#[count?Store at most \acount\a lines.  If \acount\a is \b0\b, all lines are "   \
+    "stored.]"                                                                           \
+    "[O]#[origin?Store the first line at index \aorigin\a and do not unset \avar\a "     \
+    "first.]"                                                                            \
+    "[s]#[count?Discard the first \acount\a lines.]"                                     \
+    "[t?Remove the delimiter from the end of each line.]"                                \
+    "[u]:[fd:=0?Read from file descriptor number \afd\a instead of standard input.]"     \
+    "\n"                                                                                 \
+    "\n[var]\n"                                                                          \
+    "\n"                                                                                 \
+    "[+EXIT STATUS?]{"                                                                   \
+    "[+0?Successful completion.]"                                                        \
+    "[+>0?An error occurred.]"                                                           \
+    "}"                                                                                  \
+    "[+SEE ALSO?\bread\b(1)]"
+
+const char sh_optmapfile[] =
+    "[-1c?\n@(#)$Id: mapfile (AT&T Research) 2026-10-17 $\n]" USAGE_LICENSE
+    "[+NAME?mapfile - read lines into an indexed array]"
+    "[+DESCRIPTION?\bmapfile\b reads lines from standard input into the indexed "
+    "array \avar\a, one line per element starting at index 0.]" _MAPFILE_;
+
+const char sh_optreadarray[] =
+    "[-1c?\n@(#)$Id: readarray (AT&T Research) 2026-10-17 $\n]" USAGE_LICENSE
+    "[+NAME?readarray - read lines into an indexed array]"
+    "[+DESCRIPTION?\breadarray\b reads lines from standard input into the indexed "
+    "array \avar\a, one line per element starting at index 0.]" _MAPFILE_;
+
 const char sh_optprint[] =
     "[-1c?\n@(#)$Id: print (AT&T Research) 2014-05-25 $\n]" USAGE_LICENSE
     "[+NAME?print - write arguments to standard output]"
@@ -1747,7 +1787,7 @@ const char sh_optunalias[] = "[-1c?\n@(#)$Id: unalias (AT&T Research) 1999-07-07
                              "[+SEE ALSO?\balias\b(1)]";
 
 const char sh_optwait[] =
-    "[-1c?\n@(#)$Id: wait (AT&T Research) 1999-06-17 $\n]" USAGE_LICENSE
+    "[-1c?\n@(#)$Id: wait (AT&T Research) 2026-10-17 $\n]" USAGE_LICENSE
     "[+NAME?wait - wait for process or job completion]"
     "[+DESCRIPTION?\bwait\b with no operands, waits until all jobs "
     "known to the invoking shell have terminated.  If one or more "
@@ -1756,6 +1796,12 @@ const char sh_optwait[] =
     "[+?If one ore more \ajob\a operands is a process id or process group id "
     "not known by the current shell environment, \bwait\b treats each "
     "of them as if it were a process that exited with status 127.]"
+    "[n?Wait until one of the \ajob\as, or any background job or coprocess "
+    "when there are no \ajob\a operands, has terminated and exit with its "
+    "status.  Jobs that terminated before \bwait\b was invoked and have not "
+    "been waited for are reported first, in the order they terminated.]"
+    "[p]:[var?Assign the process id of the job whose status is the exit status "
+    "of \bwait\b to \avar\a.  \avar\a is unset if there is no such job.]"
     "\n"
     "\n[job ...]\n"
     "\n"
@@ -1766,7 +1812,8 @@ const char sh_optwait[] =
     "[+0?\bwait\b utility was invoked with no operands and all "
     "processes known by the invoking process have terminated.]"
     "[+127?\ajob\a is a process id or process group id that is unknown "
-    "to the current shell environment.]"
+    "to the current shell environment, or \b-n\b was specified and "
+    "there was no job to wait for.]"
     "}"
     "[+SEE ALSO?\bjobs\b(1), \bps\b(1)]";
 
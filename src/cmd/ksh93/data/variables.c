@@ -142,4 +142,12 @@ const Shtable_t shtab_stats[] = {{"arg_cachehits", NV_RDONLY | NV_MINIMAL | NV_N
                                  {"simplecmds", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
                                  {"spawns", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
                                  {"subshell", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"env_cachehits", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"path_cachehits", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"regex_cachehits", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"regex_cachemisses", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"comsub_cachehits", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"fpath_cachehits", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"bltin_cachehits", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
+                                 {"bltin_cachemisses", NV_RDONLY | NV_MINIMAL | NV_NOFREE | NV_INTEGER},
                                  {"", 0}};
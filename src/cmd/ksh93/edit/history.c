@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -62,6 +63,7 @@ static History_t *hist_trim(History_t *, int);
 static int hist_nearend(History_t *, Sfio_t *, off_t);
 static int hist_check(int);
 static int hist_clean(int);
+static void hist_unmap(History_t *);
 #ifdef SF_BUFCONST
 static ssize_t hist_write(Sfio_t *, const void *, size_t, Sfdisc_t *);
 static int hist_exceptf(Sfio_t *, int, void *, Sfdisc_t *);
@@ -270,6 +272,7 @@ retry:
 // Close the history file and free the space.
 //
 void hist_close(History_t *hp) {
+    hist_unmap(hp);
     sfclose(hp->histfp);
     if (hp->auditfp) {
         if (hp->tty) free(hp->tty);
@@ -386,6 +389,7 @@ static History_t *hist_trim(History_t *hp, int n) {
         sfwrite(hist_new->histfp, buff, c);
     }
     hist_cancel(hist_new);
+    hist_unmap(hist_old);
     sfclose(hist_old->histfp);
     if (tmpname) {
         unlink(tmpname);
@@ -410,7 +414,7 @@ static int hist_nearend(History_t *hp, Sfio_t *iop, off_t size) {
     // Skip to marker command and return the number. Numbering commands occur after a null and begin
     // with HIST_CMDNO.
     while (true) {
-        cp = buff = (unsigned char *)sfreserve(iop, SF_UNBOUND, SF_LOCKR | SF_WRITE);
+        cp = buff = (unsigned char *)sfreserve(iop, SF_UNBOUND, SF_LOCKR);
         if (!cp) break;
 
         n = sfvalue(iop);
@@ -530,8 +534,10 @@ again:
                 }
             }
             first = cp;
-            while (*cp) {
-                if (++cp >= endbuff) goto refill;
+            cp = memchr(cp, 0, endbuff - cp);
+            if (!cp) {
+                cp = endbuff;
+                goto refill;
             }
             incmd = 0;
             while (*cp == 0) {
@@ -727,6 +733,39 @@ void hist_list(History_t *hp, Sfio_t *outfile, off_t offset, int last, const cha
     return;
 }
 
+//
+// Map the history file so that hist_match() can search the commands in place instead of reading
+// each one back through the stream. The file only grows while it is shared, so the mapping is
+// only replaced when its size has changed. Commands past the end of the mapping, such as those
+// still in the stream buffer, are read from the stream.
+//
+static void hist_map(History_t *hp) {
+    struct stat statb;
+    void *addr;
+
+    if (fstat(sffileno(hp->histfp), &statb) < 0 || !S_ISREG(statb.st_mode)) {
+        hist_unmap(hp);
+        return;
+    }
+    if (hp->histmap && (size_t)statb.st_size == hp->histmapsize) return;
+    hist_unmap(hp);
+    if (statb.st_size <= 0) return;
+    addr = mmap(NULL, statb.st_size, PROT_READ, MAP_SHARED, sffileno(hp->histfp), 0);
+    if (addr == MAP_FAILED) return;
+    hp->histmap = addr;
+    hp->histmapsize = statb.st_size;
+}
+
+//
+// Remove the mapping made by hist_map().
+//
+static void hist_unmap(History_t *hp) {
+    if (!hp->histmap) return;
+    munmap(hp->histmap, hp->histmapsize);
+    hp->histmap = NULL;
+    hp->histmapsize = 0;
+}
+
 //
 // Find index for last line with given string. If flag==0 then line must begin with string. Set
 // direction < 1 for backwards search.
@@ -761,6 +800,7 @@ Histloc_t hist_find(History_t *hp, char *string, int index1, int flag, int direc
     } else if (index1 >= index2) {
         return location;
     }
+    hist_map(hp);
     while (index1 != index2) {
         direction > 0 ? ++index1 : --index1;
         offset = hist_tell(hp, index1);
@@ -784,11 +824,32 @@ int hist_match(History_t *hp, off_t offset, char *string, int *coffset) {
     char *first, *cp;
     int m, n, c = 1, line = 0;
 
-    sfseek(hp->histfp, offset, SEEK_SET);
-    cp = first = sfgetr(hp->histfp, 0, 0);
-    if (!cp) return -1;
-    m = sfvalue(hp->histfp);
+    if (hp->histmap && offset >= 0 && offset < (off_t)hp->histmapsize &&
+        (cp = memchr(hp->histmap + offset, 0, hp->histmapsize - offset))) {
+        // The command is all in the mapped part of the file.
+        first = hp->histmap + offset;
+        m = cp + 1 - first;
+    } else {
+        sfseek(hp->histfp, offset, SEEK_SET);
+        first = sfgetr(hp->histfp, 0, 0);
+        if (!first) return -1;
+        m = sfvalue(hp->histfp);
+    }
+    cp = first;
     n = (int)strlen(string);
+    // Every position the loop below visits can start a match of a string that does not begin with
+    // a UTF-8 continuation byte, so the search can be left to memmem().
+    if (coffset && n > 0 &&
+        (!mbwide() || (ast.locale.is_utf8 && (*(unsigned char *)string & 0xc0) != 0x80))) {
+        cp = memmem(first, m - 1, string, n);
+        if (!cp) return -1;
+        *coffset = cp - first;
+        while ((first = memchr(first, '\n', cp - first))) {
+            first++;
+            line++;
+        }
+        return line;
+    }
     while (m > n) {
         if (*cp == *string && strncmp(cp, string, n) == 0) {
             if (coffset) *coffset = (cp - first);
@@ -924,6 +985,7 @@ static int hist_exceptf(Sfio_t *fp, int type, Sfdisc_t *handle)
         int newfd = open(hp->histname, O_BINARY | O_APPEND | O_CREAT | O_RDWR | O_CLOEXEC,
                          S_IRUSR | S_IWUSR);
         int oldfd = sffileno(fp);
+        hist_unmap(hp);
         sh_close(oldfd);
         if (newfd == -1) goto fail;
 
@@ -82,6 +82,7 @@ extern int b_command(int, char *[], Shbltin_t *);
 extern int b_getopts(int, char *[], Shbltin_t *);
 extern int b_hist(int, char *[], Shbltin_t *);
 extern int b_let(int, char *[], Shbltin_t *);
+extern int b_mapfile(int, char *[], Shbltin_t *);
 extern int b_read(int, char *[], Shbltin_t *);
 extern int b_ulimit(int, char *[], Shbltin_t *);
 extern int b_umask(int, char *[], Shbltin_t *);
@@ -146,10 +147,12 @@ extern const char sh_optjobs[];
 extern const char sh_optkill[];
 extern const char sh_optksh[];
 extern const char sh_optlet[];
+extern const char sh_optmapfile[];
 extern const char sh_optprint[];
 extern const char sh_optprintf[];
 extern const char sh_optpwd[];
 extern const char sh_optread[];
+extern const char sh_optreadarray[];
 extern const char sh_optreadonly[];
 extern const char sh_optreturn[];
 extern const char sh_optset[];
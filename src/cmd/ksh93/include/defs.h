@@ -38,7 +38,6 @@
 #define Empty ((char *)(e_sptbnl + 3))
 #define env_change() (++ast.env_serial)
 #define Env_t void
-#define sh_envput(e, p) env_change()
 #define env_delete(e, p) env_change()
 
 // Shell options.
@@ -216,6 +215,8 @@ struct shared {
 #define SH_READEVAL 0x4000  // for sh_eval
 #define SH_FUNEVAL 0x10000  // for sh_eval for function load
 
+#define SH_ASSIGN_ELEM 2  // for sh_assignok when only the current array element is assigned
+
 extern struct shared *shgd;
 extern void sh_outname(Shell_t *, Sfio_t *, char *, int);
 extern void sh_applyopts(Shell_t *, Shopt_t);
@@ -234,6 +235,8 @@ extern int sh_debug(Shell_t *shp, const char *, const char *, const char *, char
 extern int sh_echolist(Shell_t *, Sfio_t *, int, char **);
 extern struct argnod *sh_endword(Shell_t *, int);
 extern char **sh_envgen(Shell_t *);
+extern void sh_envprefork(Shell_t *);
+extern void sh_envput(Shell_t *, Namval_t *);
 extern void sh_envnolocal(Namval_t *, void *);
 extern Sfdouble_t sh_arith(Shell_t *, const char *);
 extern void *sh_arithcomp(Shell_t *, char *);
@@ -343,6 +346,15 @@ extern const char e_dict[];
 #define STAT_SCMDS 11
 #define STAT_SPAWN 12
 #define STAT_SUBSHELL 13
+#define STAT_ENVHITS 14
+#define STAT_PATHHITS 15
+// These two are the libast regcache() counters, see stat_init().
+#define STAT_REGHITS 16
+#define STAT_REGMISSES 17
+#define STAT_COMSUBHITS 18
+#define STAT_FPATHHITS 19
+#define STAT_BLTINHITS 20
+#define STAT_BLTINMISSES 21
 extern const Shtable_t shtab_stats[];
 #define sh_stats(x) (shgd->stats[(x)]++)
 extern const Shtable_t shtab_siginfo[];
@@ -61,6 +61,8 @@ typedef struct {
     Sfio_t *auditfp;
     char *tty;
     int auditmask;
+    char *histmap;      // read only mapping of the history file, see hist_map()
+    size_t histmapsize;
     off_t histcmds[2];  // offset for recent commands, must be last
 } History_t;
 
@@ -69,6 +69,7 @@ extern int tty_ld, ntty_ld;
 struct process {
     struct process *p_nxtjob;   // next job structure
     struct process *p_nxtproc;  // next process in current job
+    struct process *p_nxtpid;   // next process in pid hash bucket
     Shell_t *p_shp;             // shell that posted the job
     char *p_curdir;             // current direcory at job start
 #if SHOPT_COSHELL
@@ -165,7 +166,7 @@ extern const char e_oldtty[];
 // The following are defined in jobs.c.
 //
 extern void job_clear(Shell_t *);
-extern void job_bwait(char **);
+extern pid_t job_bwait(char **, bool);
 extern int job_walk(Shell_t *, Sfio_t *, int (*)(struct process *, int), int, char *[]);
 extern int job_kill(struct process *, int);
 extern bool job_wait(pid_t);
@@ -84,6 +84,8 @@ struct Value {
     const char *filename;
     int line_num;
     enum value_type type;
+    uint32_t slen;  // length of a string value allocated by nv_putval(), if scap is not zero
+    uint32_t scap;  // bytes allocated for that string, or'ed with VALUE_ASCII; zero if unknown
     union {
         void *vp;
         char *cp;
@@ -119,6 +121,10 @@ struct Value {
     } _val;
 };
 
+// Set in the scap field of a struct Value when the string has only ASCII characters. The allocated
+// size recorded there is always even.
+#define VALUE_ASCII 1
+
 // I dislike macros like these but since C doesn't support polymorphism directly this is the most
 // straightforward way to access any of the fields of the value union.
 //
@@ -172,13 +178,15 @@ struct Value {
 
 // Always store all the meta data. Even if building without the getter checks enabled. That's
 // because a) the info may be useful when debugging core dumps, and b) the value type is needed for
-// the IS_VT macro.
+// the IS_VT macro. A store also forgets the string length recorded by nv_putval() since the value
+// may no longer be that string.
 #define store_vt(line, value_obj, which, val)              \
     do {                                                   \
         (value_obj).funcname = __FUNCTION__;               \
         (value_obj).filename = strrchr(__FILE__, '/') + 1; \
         (value_obj).line_num = line;                       \
         (value_obj).type = VT_##which;                     \
+        (value_obj).scap = 0;                              \
         (value_obj)._val.which = val;                      \
     } while (0)
 
@@ -188,6 +196,7 @@ struct Value {
         (value_objp)->filename = strrchr(__FILE__, '/') + 1; \
         (value_objp)->line_num = line;                       \
         (value_objp)->type = VT_##which;                     \
+        (value_objp)->scap = 0;                              \
         (value_objp)->_val.which = val;                      \
     } while (0)
 
@@ -509,6 +518,9 @@ extern Namarr_t *nv_setarray(Namval_t *, void *(*)(Namval_t *, const char *, Nva
 extern int nv_arraynsub(Namarr_t *);
 extern void *nv_associative(Namval_t *, const char *, Nvassoc_op_t);
 extern int nv_aindex(Namval_t *);
+extern char *nv_aiexchange(Namval_t *, int, char *);
+extern int nv_aisave(Namval_t *, const char **);
+extern bool nv_aistore(Namval_t *, int, int, char *[]);
 extern bool nv_nextsub(Namval_t *);
 extern char *nv_getsub(Namval_t *);
 extern Namval_t *nv_putsub(Namval_t *, char *, long, nvflag_t);
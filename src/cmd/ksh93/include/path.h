@@ -40,6 +40,8 @@
 #define PATH_OFFSET 2  // path offset for path_join
 #define MAXDEPTH 1024  // maximum recursion depth
 
+struct dircache;
+
 //
 // Path component structure for path searching.
 //
@@ -53,6 +55,7 @@ struct pathcomp {
     char *lib;
     char *bbuf;
     char *blib;
+    struct dircache *dircache;  // names in the directory, see path_dirmiss()
     unsigned short len;
     unsigned short flags;
     Shell_t *shp;
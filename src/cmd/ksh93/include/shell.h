@@ -169,7 +169,7 @@ struct Shell_s {
     char login_sh;
     char lastbase;
     char forked;
-    char binscript;
+    char binscript;  // sh_tdump() version of the compiled script being read
     char deftype;
     char funload;
     char used_pos;  // used postional parameter
@@ -188,6 +188,7 @@ struct Shell_s {
     char redir0;            // redirect of 0
     char intrace;           // set when trace expands PS4
     char *readscript;       // set before reading a script
+    Sfio_t *treedump;       // next sh_eval() saves the trees it parses here
     int subdup;             // bitmask for dups of 1
     int *inpipe;            // input pipe pointer
     int *outpipe;           // output pipe pointer
@@ -205,6 +206,7 @@ struct Shell_s {
     int xargexit;
     int nenv;
     int lexsize;
+    unsigned int aliasgen;  // changed whenever an alias is set or unset
     Sflong_t sigval;
     mode_t mask;
     Env_t *env;
@@ -112,6 +112,37 @@ struct swnod {
     struct regnod *swlst;
     struct ionod *swio;
     int64_t swline;
+    struct swindex *swidx;  // pattern index built by sh_swindex(), may be NULL
+};
+
+// Case pattern kinds for struct swindex.
+#define SW_PATTERN 0  // expanded and/or matched with strmatch()
+#define SW_LITERAL 1  // ARG_RAW, compared with strcmp() and entered in the hash table
+#define SW_SIMPLE 2   // prefix*suffix or a plain string, compared bytewise
+
+struct swpat {
+    unsigned char kind;   // SW_*
+    unsigned char star;   // SW_SIMPLE pattern has a * between prefix and suffix
+    unsigned short plen;  // SW_SIMPLE prefix length
+    unsigned short slen;  // SW_SIMPLE suffix length
+};
+
+struct swlit {
+    struct swlit *next;
+    unsigned int hval;
+    int arm;             // first arm with this literal
+    int pat;             // index of the first pattern of arm
+    bool skip;           // the arms before arm have only SW_LITERAL patterns
+    struct regnod *reg;  // arm
+    const char *val;
+};
+
+// Built when a case statement is parsed so that the literal patterns before the first arm that
+// can match need not be compared one by one.
+struct swindex {
+    unsigned int mask;     // hash table size - 1
+    struct swlit **table;  // SW_LITERAL patterns, first arm only
+    struct swpat pat[];    // the patterns in the order sh_exec() visits them
 };
 
 struct regnod {
@@ -193,10 +224,16 @@ union Shnode_u {
     struct arithnod ar;
 };
 
+// Newest version of the sh_tdump() format. Version 4 adds the source offset and size of each
+// function so that `typeset -f` can print it. shcomp still writes version 3.
+#define SH_TDUMPVERSION 4
+
 extern void sh_freeup(Shell_t *);
 extern void sh_funstaks(struct slnod *, int);
 extern Sfio_t *sh_subshell(Shell_t *, Shnode_t *, volatile int, int);
-extern int sh_tdump(Sfio_t *, const Shnode_t *);
-extern Shnode_t *sh_trestore(Shell_t *, Sfio_t *);
+extern int sh_tdump(Sfio_t *, const Shnode_t *, int);
+extern Shnode_t *sh_trestore(Shell_t *, Sfio_t *, int);
+extern struct swindex *sh_swindex(Stk_t *, struct regnod *);
+extern unsigned int sh_swhash(const char *);
 
 #endif  // _SHNODES_H
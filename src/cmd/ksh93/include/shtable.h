@@ -59,6 +59,10 @@ extern const struct shtable2 shtab_variables[];
 extern const struct shtable2 shtab_aliases[];
 extern const struct shtable2 shtab_signals[];
 extern const struct shtable3 shtab_builtins[];
+// The order of the nodes of the tables above in their trees, written by mktables at build time.
+extern const unsigned short shtab_aliases_order[];
+extern const unsigned short shtab_builtins_order[];
+extern const unsigned short shtab_variables_order[];
 extern const struct shtable4 shtab_siginfo_codes[];
 extern const Shtable_t shtab_reserved[];
 extern const Shtable_t *sh_locate(const char *, const Shtable_t *, int);
@@ -27,6 +27,7 @@
 #define _STREVAL_H 1
 
 #include <math.h>
+#include <stdbool.h>
 
 #include "ast.h"
 #include "ast_float.h"
@@ -89,6 +90,8 @@ struct lval {
     char eflag;
     char userfn;
     char isfloat;
+    char isint;      // ivalue holds the exact integer value
+    Sflong_t ivalue;
 };
 
 struct mathtab {
@@ -105,6 +108,7 @@ typedef struct _arith_ {
     short staksize;
     short emode;
     short elen;
+    bool intonly;  // no floating point literals or function calls
 } Arith_t;
 #define ARITH_COMP 04       // set when compile separate from execute
 #define ARITH_ASSIGNOP 010  // set during assignment operators
@@ -152,7 +156,7 @@ typedef struct _arith_ {
 #define A_INCR 34
 #define A_DECR 35
 #define A_PUSHV 36
-// #define A_PUSHL 37
+#define A_PUSHL 37
 #define A_PUSHN 38
 #define A_PUSHF 39
 #define A_STORE 40
@@ -210,5 +214,6 @@ extern Sfdouble_t strval(Shell_t *, const char *, char **,
 extern Arith_t *arith_compile(Shell_t *, const char *, char **,
                               Sfdouble_t (*)(const char **, struct lval *, int, Sfdouble_t), int);
 extern Sfdouble_t arith_exec(Arith_t *);
+extern Sfdouble_t arith_execute(Arith_t *, bool *);
 
 #endif  // _STREVAL_H
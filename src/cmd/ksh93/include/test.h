@@ -57,6 +57,8 @@
 extern int test_unop(Shell_t *, int, const char *);
 extern int test_inode(const char *, const char *);
 extern int test_binop(Shell_t *, int, const char *, const char *);
+extern void test_remember(void);
+extern void test_forget(void);
 
 extern const char *sh_opttest;
 extern const char *test_opchars;
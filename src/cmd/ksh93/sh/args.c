@@ -450,7 +450,7 @@ int sh_argopts(int argc, char *argv[], void *context) {
             unsigned char *bits;
             if (argc > 0) {
                 strsort(argv, argc, sortfn);
-            } else if (np && (arp = nv_arrayptr(np)) && (args = nv_aivec(np, &bits))) {
+            } else if (np && (args = nv_aivec(np, &bits)) && (arp = nv_arrayptr(np))) {
                 char *cp;
                 int i, c, keys = 0;
 
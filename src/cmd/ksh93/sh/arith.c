@@ -296,6 +296,45 @@ static_fn Sfdouble_t number(const char *s, char **p, int b, struct lval *lvalue)
     return r;
 }
 
+//
+// Fetch the value of a signed integer variable without going through long double. Returns false
+// when the variable does not hold a plain signed integer (or has disciplines that may supply its
+// value) so that the caller falls back to nv_getnum().
+//
+static_fn bool arith_getint(Namval_t *np, Sflong_t *ip) {
+    struct Value *up = &np->nvalue;
+
+    if (nv_isattr(np, NV_DOUBLE | NV_UNSIGN | NV_BINARY) != NV_INTEGER) return false;
+    if (nv_isref(np) || (np->nvfun && np->nvfun->disc)) return false;
+    if (!FETCH_VTP(up, i32p) || FETCH_VTP(up, const_cp) == Empty) {
+        *ip = 0;
+    } else if (nv_isattr(np, NV_LONG)) {
+        *ip = *FETCH_VTP(up, i64p);
+    } else if (nv_isattr(np, NV_SHORT)) {
+        *ip = nv_isattr(np, NV_INT16P) == NV_INT16P ? *FETCH_VTP(up, i16p) : FETCH_VTP(up, i16);
+    } else {
+        *ip = *FETCH_VTP(up, i32p);
+    }
+    return true;
+}
+
+//
+// Return true if assigning the integer `i' to `np' as an NV_INT64 gives the same result as
+// assigning it as a long double. Untyped variables are formatted with LDBL_DIG significant digits
+// so larger values must take the long double path to print the same way.
+//
+static_fn bool arith_putint(Namval_t *np, Sflong_t i) {
+    static Sflong_t limit;
+
+    if (np->nvfun && np->nvfun->disc && !(nv_arrayptr(np) && !np->nvfun->next)) return false;
+    if (nv_isattr(np, NV_INTEGER)) return nv_isattr(np, NV_DOUBLE) != NV_DOUBLE;
+    if (!limit) {
+        limit = 1;
+        for (int n = LDBL_DIG < 18 ? LDBL_DIG : 18; n > 0; n--) limit *= 10;
+    }
+    return i > -limit && i < limit;
+}
+
 static_fn Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdouble_t n) {
     Shell_t *shp = lvalue->shp;
     Sfdouble_t r = 0;
@@ -306,10 +345,15 @@ static_fn Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdo
         case ASSIGN: {
             Namval_t *np = (Namval_t *)(lvalue->value);
             np = scope(np, lvalue, 1);
-            nv_putval(np, (char *)&n, NV_LDOUBLE);
+            if (lvalue->isint && arith_putint(np, lvalue->ivalue)) {
+                nv_putval(np, (char *)&lvalue->ivalue, NV_INT64);
+            } else {
+                nv_putval(np, (char *)&n, NV_LDOUBLE);
+            }
             if (lvalue->eflag) lvalue->ptr = nv_hasdisc(np, &ENUM_disc);
             lvalue->eflag = 0;
             r = nv_getnum(np);
+            lvalue->isint = arith_getint(np, &lvalue->ivalue);
             lvalue->value = (char *)np;
             break;
         }
@@ -521,6 +565,7 @@ static_fn Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdo
                 }
             }
             r = nv_getnum(np);
+            lvalue->isint = arith_getint(np, &lvalue->ivalue);
             if (nv_isattr(np, NV_INTEGER | NV_BINARY) == (NV_INTEGER | NV_BINARY)) {
                 lvalue->isfloat = (r != (Sflong_t)r) ? TYPE_LD : 0;
             } else if (nv_isattr(np, (NV_DOUBLE | NV_SHORT)) == (NV_DOUBLE | NV_SHORT)) {
@@ -26,6 +26,8 @@
 #include "config_ast.h"  // IWYU pragma: keep
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -39,14 +41,25 @@
 #include "stk.h"
 
 #define NUMSIZE 11
-#define array_setbit(cp, n, b) (cp[n] |= (b))
-#define array_clrbit(cp, n, b) (cp[n] &= ~(b))
-#define array_isbit(cp, n, b) (cp[n] & (b))
+#define array_setbit(ap, n, b) (*array_bitp(ap, n) |= (b))
+#define array_clrbit(ap, n, b) (*array_bitp(ap, n) &= ~(b))
+#define array_isbit(ap, n, b) (array_bits(ap, n) & (b))
 #define NV_CHILD NV_EXPORT
 #define ARRAY_CHILD 1
 #define ARRAY_NOFREE 2
 #define ARRAY_UNSET 4
 
+// Indexed arrays whose highest subscript is at least ARRAY_SPARSE and that have fewer than one
+// element in ARRAY_DENSITY set are stored as an ordered dictionary of ARRAY_CHUNK element chunks
+// rather than as a vector. They revert to a vector once at least one element in ARRAY_DENSITY/2
+// is set.
+#define ARRAY_SPARSE 1024
+#define ARRAY_DENSITY 8
+#define ARRAY_CHUNK 64
+
+// Lookups out of order, plus one per eight elements, that pay for hashing an associative array.
+#define ASSOC_REHASH 64
+
 // Constants for the `nv_associative()` "op" parameter.
 const Nvassoc_op_t ASSOC_OP_INIT = {ASSOC_OP_INIT_val};
 const Nvassoc_op_t ASSOC_OP_FREE = {ASSOC_OP_FREE_val};
@@ -58,14 +71,23 @@ const Nvassoc_op_t ASSOC_OP_ADD2 = {ASSOC_OP_ADD2_val};
 const Nvassoc_op_t ASSOC_OP_CURRENT = {ASSOC_OP_CURRENT_val};
 const Nvassoc_op_t ASSOC_OP_SETSUB = {ASSOC_OP_SETSUB_val};
 
+struct index_chunk {
+    Dtlink_t link;
+    int base;                         // index of first element in chunk
+    unsigned char bits[ARRAY_CHUNK];  // bit array for child subscripts
+    struct Value val[ARRAY_CHUNK];    // array of value holders
+};
+
 struct index_array {
     Namarr_t namarr;
-    void *xp;             // if set, subscripts will be converted
-    int cur;              // index of current element
-    int last;             // index of highest assigned element
-    int maxi;             // maximum index for array
-    unsigned char *bits;  // bit array for child subscripts
-    struct Value val[1];  // array of value holders
+    void *xp;                    // if set, subscripts will be converted
+    int cur;                     // index of current element
+    int last;                    // index of highest assigned element
+    int maxi;                    // maximum index for array
+    Dt_t *sparse;                // chunks of a sparse array, NULL if the array is a vector
+    struct index_chunk *lchunk;  // most recently referenced chunk of a sparse array
+    unsigned char *bits;         // bit array for child subscripts
+    struct Value val[1];         // array of value holders
 };
 
 struct assoc_array {
@@ -73,8 +95,212 @@ struct assoc_array {
     Namval_t *pos;
     Namval_t *nextpos;
     Namval_t *cur;
+    size_t nlookup;  // lookups since the table was last ordered
+    size_t nrehash;  // lookups before hashing the table again, if more than ASSOC_REHASH asks for
+    bool rehashed;   // the table was hashed by assoc_rehash() and has not been walked since
+};
+
+//
+// Associative array tables start out as ordered sets and are hashed once enough subscripts have
+// been looked up out of order to pay for it, so that those lookups do not walk a tree. They are
+// converted back to an ordered set when the subscripts are visited in order, or when the table is
+// viewed through a scope.
+//
+struct assoc_key {
+    uint64_t prefix;  // first eight bytes of the name, the first one most significant
+    Namval_t *np;
 };
 
+static_fn int assoc_keycmp(const void *a, const void *b) {
+    const struct assoc_key *ka = a;
+    const struct assoc_key *kb = b;
+
+    if (ka->prefix != kb->prefix) return ka->prefix < kb->prefix ? -1 : 1;
+    return strcmp(ka->np->nvname, kb->np->nvname);
+}
+
+//
+// Convert a hashed table that is not in a view to an ordered set. Sorting an array that holds the
+// first bytes of each name, and inserting the elements in order, reads few names and splays
+// little, whereas cdt would merge sort the linked elements and compare every name it meets.
+//
+static_fn void assoc_sort(Dt_t *dt) {
+    ssize_t n = dtsize(dt);
+    struct assoc_key *keys = malloc(n * sizeof(struct assoc_key) + 1);
+    struct assoc_key *kp = keys;
+
+    assert(keys);
+    for (Namval_t *np = dtfirst(dt); np; np = dtnext(dt, np), kp++) {
+        const unsigned char *cp = (const unsigned char *)np->nvname;
+        kp->prefix = 0;
+        for (int i = 0; i < 8; i++) {
+            kp->prefix <<= 8;
+            if (*cp) kp->prefix |= *cp++;
+        }
+        kp->np = np;
+    }
+    qsort(keys, n, sizeof(struct assoc_key), assoc_keycmp);
+    dtextract(dt);
+    dtmethod(dt, Dtoset);
+    for (kp = keys; kp < keys + n; kp++) dtinsert(dt, kp->np);
+    free(keys);
+}
+
+static_fn Dt_t *assoc_order(Dt_t *dt) {
+    for (Dt_t *dp = dt; dp; dp = dtvnext(dp)) {
+        if (dp->meth->type & DT_ORDERED) continue;
+        if (dp == dt && !dtvnext(dp) && !dp->nview) {
+            assoc_sort(dp);
+        } else {
+            dtmethod(dp, Dtoset);
+        }
+    }
+    return dt;
+}
+
+static_fn void assoc_rehash(struct assoc_array *ap, Namval_t *prev, const char *sp) {
+    Dt_t *dt = ap->namarr.table;
+
+    if (!(dt->meth->type & DT_ORDERED)) {
+        ap->nlookup++;
+        return;
+    }
+    if (prev && prev->nvname) {
+        // A subscript that differs from the one before only in its last two characters, as when
+        // counting up or walking, is found next to it in the splay tree.
+        size_t n = 0;
+        while (sp[n] && sp[n] == prev->nvname[n]) n++;
+        if (n > 0 && strlen(sp + n) <= 2) return;
+    }
+    if (++ap->nlookup > ap->namarr.nelem / 8 + ASSOC_REHASH && ap->nlookup > ap->nrehash &&
+        !ap->pos && !nv_isflag(ap->namarr.flags, ARRAY_SCAN) && !ap->namarr.scope &&
+        !dtvnext(dt) && !dt->nview) {
+        dtmethod(dt, Dtset);
+        ap->rehashed = true;
+    }
+}
+
+//
+// Order the table for a walk. If it was hashed since the last walk, the lookups in between did
+// not pay for sorting it again, so wait for twice as many before the next time.
+//
+static_fn void assoc_walk(struct assoc_array *ap) {
+    if (ap->rehashed) {
+        ap->rehashed = false;
+        ap->nrehash = 2 * ap->nlookup;
+    }
+    assoc_order(ap->namarr.table);
+    ap->nlookup = 0;
+}
+
+static_fn int chunk_compare(Dt_t *dt, void *a, void *b, Dtdisc_t *disc) {
+    UNUSED(dt);
+    UNUSED(disc);
+    int x = *(int *)a, y = *(int *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static_fn void chunk_free(Dt_t *dt, void *obj, Dtdisc_t *disc) {
+    UNUSED(dt);
+    UNUSED(disc);
+    free(obj);
+}
+
+static Dtdisc_t _Chunkdisc = {.key = offsetof(struct index_chunk, base),
+                              .size = sizeof(int),
+                              .link = offsetof(struct index_chunk, link),
+                              .freef = chunk_free,
+                              .comparf = chunk_compare};
+
+//
+// Return the chunk of sparse array <ap> that holds element <n>. If there is no such chunk it is
+// created when <add> is set, otherwise NULL is returned.
+//
+static_fn struct index_chunk *array_chunk(struct index_array *ap, int n, bool add) {
+    struct index_chunk *cp = ap->lchunk;
+    int base = n - n % ARRAY_CHUNK;
+
+    if (cp && cp->base == base) return cp;
+    cp = dtmatch(ap->sparse, &base);
+    if (!cp && add) {
+        cp = calloc(1, sizeof(struct index_chunk));
+        cp->base = base;
+        memset(cp->bits, ARRAY_UNSET, ARRAY_CHUNK);
+        for (n = 0; n < ARRAY_CHUNK; n++) STORE_VT(cp->val[n], const_cp, NULL);
+        dtinsert(ap->sparse, cp);
+    }
+    if (cp) ap->lchunk = cp;
+    return cp;
+}
+
+//
+// Return the value holder for element <n> of <ap>, creating it if the array is sparse.
+//
+static_fn struct Value *array_slot(struct index_array *ap, int n) {
+    if (!ap->sparse) return &ap->val[n];
+    return &array_chunk(ap, n, true)->val[n % ARRAY_CHUNK];
+}
+
+//
+// Like array_slot() but never creates storage. The returned value holder must not be modified.
+//
+static_fn const struct Value *array_peek(struct index_array *ap, int n) {
+    static const struct Value nullval;
+    struct index_chunk *cp;
+
+    if (!ap->sparse) return &ap->val[n];
+    cp = array_chunk(ap, n, false);
+    return cp ? &cp->val[n % ARRAY_CHUNK] : &nullval;
+}
+
+static_fn unsigned char *array_bitp(struct index_array *ap, int n) {
+    if (!ap->sparse) return &ap->bits[n];
+    return &array_chunk(ap, n, true)->bits[n % ARRAY_CHUNK];
+}
+
+static_fn int array_bits(struct index_array *ap, int n) {
+    struct index_chunk *cp;
+
+    if (!ap->sparse) return ap->bits[n];
+    cp = array_chunk(ap, n, false);
+    return cp ? cp->bits[n % ARRAY_CHUNK] : ARRAY_UNSET;
+}
+
+//
+// Return the smallest index >= <n> of <ap> that may hold an element, or ap->maxi if none.
+//
+static_fn int array_next(struct index_array *ap, int n) {
+    struct index_chunk key, *cp;
+
+    if (!ap->sparse || n >= ap->maxi) return n < ap->maxi ? n : ap->maxi;
+    if (array_chunk(ap, n, false)) return n;
+    key.base = n - n % ARRAY_CHUNK;
+    cp = dtatleast(ap->sparse, &key);
+    return cp ? cp->base : ap->maxi;
+}
+
+//
+// Return the largest index <= <n> of <ap> that may hold an element, or -1 if none.
+//
+static_fn int array_prev(struct index_array *ap, int n) {
+    struct index_chunk key, *cp;
+
+    if (!ap->sparse || n < 0) return n;
+    if (array_chunk(ap, n, false)) return n;
+    key.base = n - n % ARRAY_CHUNK;
+    cp = dtatmost(ap->sparse, &key);
+    return cp ? cp->base + ARRAY_CHUNK - 1 : -1;
+}
+
+//
+// Free an indexed array including the chunks of a sparse array.
+//
+static_fn void array_free(struct index_array *ap) {
+    if (ap->sparse) dtclose(ap->sparse);
+    free(ap);
+}
+
 // Clone the index_array pointed to by `aq` and do what? What does the "scope" in the function name
 // imply?
 static_fn struct index_array *array_scope(Namval_t *np, struct index_array *aq, int flags) {
@@ -93,11 +319,16 @@ static_fn struct index_array *array_scope(Namval_t *np, struct index_array *aq,
     if (is_associative(&ar->namarr)) {
         ar->namarr.scope = dtopen(&_Nvdisc, Dtoset);
         dtuserdata(ar->namarr.scope, shp, 1);
-        dtview(ar->namarr.scope, ar->namarr.table);
+        dtview(ar->namarr.scope, assoc_order(ar->namarr.table));
         ar->namarr.table = ar->namarr.scope;
         return ar;
     }
     ar->namarr.scope = (Dt_t *)aq;
+    if (ar->sparse) {
+        ar->sparse = dtopen(&_Chunkdisc, Dtoset);
+        ar->lchunk = NULL;
+        return ar;
+    }
     memset(ar->val, 0, ar->maxi * sizeof(char *));
     ar->bits = (unsigned char *)&ar->val[ar->maxi];
     return ar;
@@ -109,7 +340,13 @@ static_fn bool array_unscope(Namval_t *np, Namarr_t *ap) {
     if (!ap->scope) return false;
     if (is_associative(ap)) (*ap->fun)(np, NULL, ASSOC_OP_FREE);
     fp = nv_disc(np, (Namfun_t *)ap, DISC_OP_POP);
-    if (fp && !(fp->nofree & 1)) free(fp);
+    if (fp && !(fp->nofree & 1)) {
+        if (is_associative(ap)) {
+            free(fp);
+        } else {
+            array_free((struct index_array *)fp);
+        }
+    }
     nv_delete(np, NULL, 0);
     return true;
 }
@@ -122,7 +359,7 @@ static_fn bool array_covered(Namval_t *np, struct index_array *ap) {
     UNUSED(np);
     struct index_array *aq = (struct index_array *)ap->namarr.scope;
     if (!is_associative(&ap->namarr) && aq) {
-        return (ap->cur < aq->maxi) && FETCH_VT(aq->val[ap->cur], const_cp);
+        return (ap->cur < aq->maxi) && FETCH_VTP(array_peek(aq, ap->cur), const_cp);
     }
     return false;
 }
@@ -161,7 +398,7 @@ int array_maxindex(Namval_t *np) {
     assert(ap);
     int i = ap->maxi;
     if (is_associative(&ap->namarr)) return -1;
-    while (--i >= 0 && !FETCH_VT(ap->val[i], const_cp)) {
+    while ((i = array_prev(ap, i - 1)) >= 0 && !FETCH_VTP(array_peek(ap, i), const_cp)) {
         ;  // empty loop
     }
     return i + 1;
@@ -190,8 +427,8 @@ static_fn struct Value *array_getup(Namval_t *np, Namarr_t *arp, int update) {
             errormsg(SH_DICT, ERROR_exit(1), e_subscript, nv_name(np));
             __builtin_unreachable();
         }
-        up = &(ap->val[ap->cur]);
-        nofree = array_isbit(ap->bits, ap->cur, ARRAY_NOFREE);
+        up = array_slot(ap, ap->cur);
+        nofree = array_isbit(ap, ap->cur, ARRAY_NOFREE);
     }
     if (update) {
         if (nofree) {
@@ -205,14 +442,14 @@ static_fn struct Value *array_getup(Namval_t *np, Namarr_t *arp, int update) {
 
 bool nv_arrayisset(Namval_t *np, Namarr_t *arp) {
     struct index_array *ap = (struct index_array *)arp;
-    struct Value *up;
+    const struct Value *up;
 
     if (is_associative(&ap->namarr)) {
         np = nv_opensub(np);
         return np && !nv_isnull(np);
     }
     if (ap->cur >= ap->maxi) return false;
-    up = &(ap->val[ap->cur]);
+    up = array_peek(ap, ap->cur);
     if (FETCH_VTP(up, const_cp) == Empty) {
         Namfun_t *fp = &arp->namfun;
         for (fp = fp->next; fp; fp = fp->next) {
@@ -288,7 +525,7 @@ static_fn Namval_t *array_find(Namval_t *np, Namarr_t *arp, int flag) {
             errormsg(SH_DICT, ERROR_exit(1), e_subscript, nv_name(np));
             __builtin_unreachable();
         }
-        up = &(ap->val[ap->cur]);
+        up = array_slot(ap, ap->cur);
         if ((!FETCH_VTP(up, const_cp) || FETCH_VTP(up, const_cp) == Empty) && nv_type(np) &&
             nv_isvtree(np)) {
             char *cp;
@@ -304,14 +541,14 @@ static_fn Namval_t *array_find(Namval_t *np, Namarr_t *arp, int flag) {
             nv_arraychild(np, mp, 0);
         }
         struct Namval *up_np = FETCH_VTP(up, np);
-        if (up_np && array_isbit(ap->bits, ap->cur, ARRAY_CHILD)) {
+        if (up_np && array_isbit(ap, ap->cur, ARRAY_CHILD)) {
             if (wasundef && nv_isarray(up_np)) nv_putsub(up_np, NULL, 0, ARRAY_UNDEF);
             return up_np;
         }
         if (flag & ARRAY_ASSIGN) {
-            array_clrbit(ap->bits, ap->cur, ARRAY_UNSET);
+            array_clrbit(ap, ap->cur, ARRAY_UNSET);
         } else if (!FETCH_VTP(up, np) && nv_isattr(np, NV_INTEGER) &&
-                   array_isbit(ap->bits, ap->cur, ARRAY_UNSET)) {
+                   array_isbit(ap, ap->cur, ARRAY_UNSET)) {
             nv_onattr(np, NV_BINARY);
         }
     }
@@ -424,7 +661,20 @@ static_fn Namfun_t *array_clone(Namval_t *np, Namval_t *mp, nvflag_t flags, Namf
     mp->nvflag |= (np->nvflag & ~(NV_MINIMAL | NV_NOFREE));
     if (!(flg & (ARRAY_SCAN | ARRAY_UNDEF)) && (sub = nv_getsub(np))) sub = strdup(sub);
     ar = (struct index_array *)ap;
-    if (!is_associative(ap)) ar->bits = (unsigned char *)&ar->val[ar->maxi];
+    if (!is_associative(ap)) {
+        if (ar->sparse) {
+            struct index_chunk *cp, *cq;
+            ar->sparse = dtopen(&_Chunkdisc, Dtoset);
+            ar->lchunk = NULL;
+            for (cp = dtfirst(aq->sparse); cp; cp = dtnext(aq->sparse, cp)) {
+                cq = malloc(sizeof(struct index_chunk));
+                memcpy(cq, cp, sizeof(struct index_chunk));
+                dtinsert(ar->sparse, cq);
+            }
+        } else {
+            ar->bits = (unsigned char *)&ar->val[ar->maxi];
+        }
+    }
     if (!nv_putsub(np, NULL, 0, ARRAY_SCAN | ((flags & NV_COMVAR) ? 0 : ARRAY_NOSCOPE))) {
         if (ap->fun) (*ap->fun)(np, (char *)np, ASSOC_OP_ADD2);
         skipped = 1;
@@ -442,21 +692,21 @@ static_fn Namfun_t *array_clone(Namval_t *np, Namval_t *mp, nvflag_t flags, Namf
         }
         if (nq && (((flags & NV_COMVAR) && nv_isvtree(nq)) || nv_isarray(nq))) {
             STORE_VT(mq->nvalue, const_cp, NULL);
-            if (!is_associative(ap)) STORE_VT(ar->val[ar->cur], np, mq);
+            if (!is_associative(ap)) STORE_VTP(array_slot(ar, ar->cur), np, mq);
             nv_clone(nq, mq, flags);
         } else if (flags & NV_ARRAY) {
             if ((flags & NV_NOFREE) && !is_associative(ap)) {
-                array_setbit(aq->bits, aq->cur, ARRAY_NOFREE);
+                array_setbit(aq, aq->cur, ARRAY_NOFREE);
             } else if (nq && (flags & NV_NOFREE)) {
                 mq->nvalue = nq->nvalue;
                 nv_onattr(nq, NV_NOFREE);
             }
         } else if (nv_isattr(np, NV_INTEGER)) {
             Sfdouble_t d = nv_getnum(np);
-            if (!is_associative(ap)) STORE_VT(ar->val[ar->cur], const_cp, NULL);
+            if (!is_associative(ap)) STORE_VTP(array_slot(ar, ar->cur), const_cp, NULL);
             nv_putval(mp, (char *)&d, NV_LDOUBLE);
         } else {
-            if (!is_associative(ap)) STORE_VT(ar->val[ar->cur], const_cp, NULL);
+            if (!is_associative(ap)) STORE_VTP(array_slot(ar, ar->cur), const_cp, NULL);
             nv_putval(mp, nv_getval(np), NV_RDONLY);
         }
         aq->namarr.flags |= ARRAY_NOSCOPE;
@@ -515,15 +765,15 @@ static_fn void array_putval(Namval_t *np, const void *string, nvflag_t flags, Na
     bool nofree = nv_isattr(np, NV_NOFREE) == NV_NOFREE;
 
     do {
-        bool xfree = is_associative(ap) ? false : array_isbit(aq->bits, aq->cur, ARRAY_NOFREE);
+        bool xfree = is_associative(ap) ? false : array_isbit(aq, aq->cur, ARRAY_NOFREE);
         mp = array_find(np, ap, string ? ARRAY_ASSIGN : ARRAY_DELETE);
         scan = ap->flags & ARRAY_SCAN;
         if (mp && mp != np) {
             if (!is_associative(ap) && string && !(flags & NV_APPEND) && !nv_type(np) &&
                 nv_isvtree(mp) && !(ap->flags & ARRAY_TREE)) {
                 if (!nv_isattr(np, NV_NOFREE)) _nv_unset(mp, flags & NV_RDONLY);
-                array_clrbit(aq->bits, aq->cur, ARRAY_CHILD);
-                STORE_VT(aq->val[aq->cur], const_cp, NULL);
+                array_clrbit(aq, aq->cur, ARRAY_CHILD);
+                STORE_VTP(array_slot(aq, aq->cur), const_cp, NULL);
                 if (!nv_isattr(mp, NV_NOFREE)) nv_delete(mp, ap->table, 0);
                 goto skip;
             }
@@ -543,8 +793,8 @@ static_fn void array_putval(Namval_t *np, const void *string, nvflag_t flags, Na
                     STORE_VT(np->nvalue, const_cp, NULL);
                 } else {
                     if (mp != np) {
-                        array_clrbit(aq->bits, aq->cur, ARRAY_CHILD);
-                        STORE_VT(aq->val[aq->cur], const_cp, NULL);
+                        array_clrbit(aq, aq->cur, ARRAY_CHILD);
+                        STORE_VTP(array_slot(aq, aq->cur), const_cp, NULL);
                         // TODO: NV_NOFREE was added here as a workaround for a use after free bug
                         // If it creates a big memory leak we should investigate another solution
                         // for it https://github.com/att/ast/issues/398
@@ -578,9 +828,9 @@ static_fn void array_putval(Namval_t *np, const void *string, nvflag_t flags, Na
         if (nofree && !FETCH_VTP(up, const_cp)) STORE_VTP(up, const_cp, Empty);
         if (!is_associative(ap)) {
             if (string) {
-                array_clrbit(aq->bits, aq->cur, ARRAY_NOFREE);
+                array_clrbit(aq, aq->cur, ARRAY_NOFREE);
             } else if (mp == np) {
-                STORE_VT(aq->val[aq->cur], const_cp, NULL);
+                STORE_VTP(array_slot(aq, aq->cur), const_cp, NULL);
             }
         }
         if (string && ap->namfun.type && nv_isvtree(np)) {
@@ -601,8 +851,12 @@ static_fn void array_putval(Namval_t *np, const void *string, nvflag_t flags, Na
         }
         nfp = nv_disc(np, &ap->namfun, DISC_OP_POP);
         if (nfp && !(nfp->nofree & 1)) {
+            if (is_associative(ap)) {
+                free(nfp);
+            } else {
+                array_free((struct index_array *)nfp);
+            }
             ap = NULL;
-            free(nfp);
         }
         if (!nv_isnull(np)) {
             if (!np->nvfun) nv_onattr(np, NV_NOFREE);
@@ -635,40 +889,79 @@ static_fn void array_copytree(Namval_t *np, Namval_t *mp) {
     mp->nvenv = np;
 }
 
+//
+// Return true if indexed array <arp> should have sparse storage when <maxi> is a legal index.
+// Arrays that would be mostly unset are made sparse, and sparse arrays that have filled in are
+// converted back to a vector.
+//
+static_fn bool array_issparse(struct index_array *arp, int maxi) {
+    int top = maxi + 1, nelem = arp ? array_elem(&arp->namarr) : 0;
+
+    if (arp && arp->sparse) {
+        struct index_chunk *cp = dtlast(arp->sparse);
+        if (cp && cp->base + ARRAY_CHUNK > top) top = cp->base + ARRAY_CHUNK;
+        return top > nelem * (ARRAY_DENSITY / 2);
+    }
+    return top >= ARRAY_SPARSE && top / ARRAY_DENSITY > nelem;
+}
+
 //
 // Increase the size of the indexed array of elements in <arp> so that <maxi>
 // is a legal index.  If <arp> is 0, an array of the required size is
 // allocated.  A pointer to the allocated Namarr_t structure is returned.
-// <maxi> becomes the current index of the array.
+// <maxi> becomes the current index of the array.  The array is stored as a
+// vector unless <sparse> is set.
 //
-static_fn struct index_array *array_grow(Namval_t *np, struct index_array *arp, int maxi) {
+static_fn struct index_array *array_resize(Namval_t *np, struct index_array *arp, int maxi,
+                                           bool sparse) {
     struct index_array *ap;
-    int i;
-    // cppcheck-suppress integerOverflowCond
-    int newsize = arsize(arp, maxi + 1);
+    int i, newsize;
     size_t size;
 
     if (maxi >= ARRAY_MAX) {
         errormsg(SH_DICT, ERROR_exit(1), e_subscript, fmtbase((long)maxi, 10, 0));
         __builtin_unreachable();
     }
-    size = (newsize - 1) * sizeof(struct Value) + newsize;
+    if (arp && arp->sparse && sparse) {
+        arp->cur = maxi;
+        return arp;
+    }
+    if (sparse) {
+        newsize = ARRAY_MAX - 1;  // every legal subscript is less than this
+        size = 0;
+    } else {
+        int top = maxi + 1;
+        if (arp && arp->sparse) {
+            struct index_chunk *cp = dtlast(arp->sparse);
+            if (cp && cp->base + ARRAY_CHUNK > top) top = cp->base + ARRAY_CHUNK;
+        }
+        // cppcheck-suppress integerOverflowCond
+        newsize = arsize(arp && !arp->sparse ? arp : NULL, top);
+        size = (newsize - 1) * sizeof(struct Value) + newsize;
+    }
     ap = calloc(1, sizeof(*ap) + size);
     ap->maxi = newsize;
     ap->cur = maxi;
-    ap->bits = (unsigned char *)&ap->val[newsize];
-    memset(ap->bits, ARRAY_UNSET, newsize);
+    if (sparse) {
+        ap->sparse = dtopen(&_Chunkdisc, Dtoset);
+    } else {
+        ap->bits = (unsigned char *)&ap->val[newsize];
+        memset(ap->bits, ARRAY_UNSET, newsize);
+        for (i = 0; i < newsize; i++) STORE_VT(ap->val[i], const_cp, NULL);
+    }
     if (arp) {
         ap->namarr = arp->namarr;
         ap->namarr.namfun.dsize = sizeof(*ap) + size;
         ap->last = arp->last;
-        for (i = 0; i < arp->maxi; i++) {
-            ap->bits[i] = arp->bits[i];
-            STORE_VT(ap->val[i], const_cp, FETCH_VT(arp->val[i], const_cp));
+        for (i = array_next(arp, 0); i < arp->maxi; i = array_next(arp, i + 1)) {
+            const char *cp = FETCH_VTP(array_peek(arp, i), const_cp);
+            int bits = array_bits(arp, i);
+            if (!cp && bits == ARRAY_UNSET) continue;
+            *array_bitp(ap, i) = bits;
+            STORE_VTP(array_slot(ap, i), const_cp, cp);
         }
-        memcpy(ap->bits, arp->bits, arp->maxi);
         array_setptr(np, arp, ap);
-        free(arp);
+        array_free(arp);
     } else {
         int flags = 0;
         Namval_t *mp = NULL;
@@ -688,8 +981,8 @@ static_fn struct index_array *array_grow(Namval_t *np, struct index_array *arp,
             mp = nv_search("0", ap->namarr.table, NV_ADD);
             if (mp && nv_isnull(mp)) {
                 Namfun_t *fp;
-                STORE_VT(ap->val[0], np, mp);
-                array_setbit(ap->bits, 0, ARRAY_CHILD);
+                STORE_VTP(array_slot(ap, 0), np, mp);
+                array_setbit(ap, 0, ARRAY_CHILD);
                 for (fp = np->nvfun; fp && !fp->disc->readf; fp = fp->next) {
                     ;  // empty loop
                 }
@@ -698,7 +991,7 @@ static_fn struct index_array *array_grow(Namval_t *np, struct index_array *arp,
             }
         } else {
             const char *cp = FETCH_VT(np->nvalue, const_cp);
-            STORE_VT(ap->val[0], const_cp, cp);
+            STORE_VTP(array_slot(ap, 0), const_cp, cp);
             if (cp) {
                 i++;
             } else if (nv_isattr(np, NV_INTEGER) && !nv_isnull(np)) {
@@ -718,10 +1011,13 @@ static_fn struct index_array *array_grow(Namval_t *np, struct index_array *arp,
             ap->namarr.namfun.nofree &= ~1;
         }
     }
-    for (; i < newsize; i++) STORE_VT(ap->val[i], const_cp, NULL);
     return ap;
 }
 
+static_fn struct index_array *array_grow(Namval_t *np, struct index_array *arp, int maxi) {
+    return array_resize(np, arp, maxi, array_issparse(arp, maxi));
+}
+
 bool nv_atypeindex(Namval_t *np, const char *tname) {
     Shell_t *shp = sh_ptr(np);
     Namval_t *tp;
@@ -781,8 +1077,10 @@ static_fn Namarr_t *nv_changearray(Namval_t *np,
     ap->fun = fun;
     nv_onattr(np, NV_ARRAY);
 
-    for (dot = 0; dot < (unsigned)save_ap->maxi; dot++) {
-        if (FETCH_VT(save_ap->val[dot], const_cp)) {
+    for (dot = array_next(save_ap, 0); dot < (unsigned)save_ap->maxi;
+         dot = array_next(save_ap, dot + 1)) {
+        struct Value *vp = array_slot(save_ap, dot);
+        if (FETCH_VTP(vp, const_cp)) {
             if ((digit = dot) == 0) {
                 *--string_index = '0';
             } else {
@@ -793,12 +1091,12 @@ static_fn Namarr_t *nv_changearray(Namval_t *np,
             }
             nv_putsub(np, string_index, 0, ARRAY_ADD);
             up = (struct Value *)((*ap->fun)(np, NULL, ASSOC_OP_ADD2));
-            STORE_VTP(up, const_cp, FETCH_VT(save_ap->val[dot], const_cp));
-            STORE_VT(save_ap->val[dot], const_cp, NULL);
+            STORE_VTP(up, const_cp, FETCH_VTP(vp, const_cp));
+            STORE_VTP(vp, const_cp, NULL);
         }
         string_index = &numbuff[NUMSIZE];
     }
-    free(save_ap);
+    array_free(save_ap);
     return ap;
 }
 
@@ -886,8 +1184,8 @@ Namval_t *nv_arraychild(Namval_t *np, Namval_t *nq, int c) {
     }
     if (!ap->fun) {
         struct index_array *aq = (struct index_array *)ap;
-        array_setbit(aq->bits, aq->cur, ARRAY_CHILD);
-        array_clrbit(aq->bits, aq->cur, ARRAY_UNSET);
+        array_setbit(aq, aq->cur, ARRAY_CHILD);
+        array_clrbit(aq, aq->cur, ARRAY_UNSET);
         if (c == '.' && !FETCH_VT(nq->nvalue, const_cp)) ap->nelem++;
         STORE_VTP(up, np, nq);
     }
@@ -914,19 +1212,29 @@ bool nv_nextsub(Namval_t *np) {
     }
     if (!(ap->namarr.flags & ARRAY_NOSCOPE)) ar = (struct index_array *)ap->namarr.scope;
     for (dot = ap->cur + 1; dot < (unsigned)ap->maxi; dot++) {
+        const struct Value *vp;
+        if (ap->sparse || (ar && ar->sparse)) {
+            // Skip over chunks of a sparse array that have no elements.
+            unsigned next = array_next(ap, dot);
+            if (ar && !(ap->namarr.flags & ARRAY_NOSCOPE) && dot < (unsigned)ar->maxi) {
+                unsigned rnext = array_next(ar, dot);
+                if (rnext < next) next = rnext;
+            }
+            if ((dot = next) >= (unsigned)ap->maxi) break;
+        }
         aq = ap;
-        if (!FETCH_VT(ap->val[dot], const_cp) && !(ap->namarr.flags & ARRAY_NOSCOPE)) {
+        if (!FETCH_VTP(array_peek(ap, dot), const_cp) && !(ap->namarr.flags & ARRAY_NOSCOPE)) {
             if (!(aq = ar) || dot >= (unsigned)aq->maxi) continue;
         }
-        if (FETCH_VT(aq->val[dot], const_cp) == Empty &&
-            array_elem(&aq->namarr) < nv_aimax(np) + 1) {
+        vp = array_peek(aq, dot);
+        if (FETCH_VTP(vp, const_cp) == Empty && array_elem(&aq->namarr) < nv_aimax(np) + 1) {
             ap->cur = dot;
             if (nv_getval(np) == Empty) continue;
         }
-        if (FETCH_VT(aq->val[dot], const_cp)) {
+        if (FETCH_VTP(vp, const_cp)) {
             ap->cur = dot;
-            if (array_isbit(aq->bits, dot, ARRAY_CHILD)) {
-                Namval_t *mp = FETCH_VT(aq->val[dot], np);
+            if (array_isbit(aq, dot, ARRAY_CHILD)) {
+                Namval_t *mp = FETCH_VTP(vp, np);
                 if ((aq->namarr.flags & ARRAY_NOCHILD) && nv_isvtree(mp) && !mp->nvfun->dsize) {
                     continue;
                 }
@@ -978,6 +1286,11 @@ Namval_t *nv_putsub(Namval_t *np, char *sp, long size, nvflag_t flags) {
             if (size == 0 && !(flags & ARRAY_FILL)) return NULL;
             if (shp->subshell) np = sh_assignok(np, 1);
             ap = array_grow(np, ap, size);
+        } else if (ap->sparse && (flags & ARRAY_ADD) &&
+                   !FETCH_VTP(array_peek(ap, size), const_cp)) {
+            // Adding an element may make a sparse array dense enough to be a vector.
+            if (shp->subshell) np = sh_assignok(np, 1);
+            ap = array_grow(np, ap, size);
         }
         ap->namarr.flags &= ~ARRAY_UNDEF;
         ap->namarr.flags |= (flags & (ARRAY_SCAN | ARRAY_NOCHILD | ARRAY_UNDEF | ARRAY_NOSCOPE));
@@ -1003,22 +1316,27 @@ Namval_t *nv_putsub(Namval_t *np, char *sp, long size, nvflag_t flags) {
             if (!(flags & ARRAY_ADD)) {
                 int n;
                 if (flags & ARRAY_SETSUB) {
-                    for (n = 0; n <= ap->maxi; n++) STORE_VT(ap->val[n], const_cp, NULL);
+                    if (ap->sparse) {
+                        for (n = array_next(ap, 0); n < ap->maxi; n = array_next(ap, n + 1)) {
+                            STORE_VTP(array_slot(ap, n), const_cp, NULL);
+                        }
+                    } else {
+                        for (n = 0; n <= ap->maxi; n++) STORE_VT(ap->val[n], const_cp, NULL);
+                    }
                     ap->namarr.nelem = 0;
                     ap->namarr.flags = 0;
                 }
                 for (n = 0; n <= size; n++) {
-                    if (!FETCH_VT(ap->val[n], const_cp)) {
-                        array_clrbit(ap->bits, n, ARRAY_UNSET);
-                        STORE_VT(ap->val[n], const_cp, Empty);
+                    struct Value *vp = array_slot(ap, n);
+                    if (!FETCH_VTP(vp, const_cp)) {
+                        array_clrbit(ap, n, ARRAY_UNSET);
+                        STORE_VTP(vp, const_cp, Empty);
                         if (!array_covered(np, ap)) ap->namarr.nelem++;
                     }
                     ap->last = ap->namarr.nelem;
                 }
-                n = ap->maxi - ap->maxi;
-                if (n) memset(&ap->val[size], 0, n * sizeof(struct Value));
-            } else if (!(sp = (char *)FETCH_VT(ap->val[size], const_cp)) || sp == Empty) {
-                if (shp->subshell) np = sh_assignok(np, 1);
+            } else if (!(sp = (char *)FETCH_VTP(array_peek(ap, size), const_cp)) || sp == Empty) {
+                if (shp->subshell) np = sh_assignok(np, SH_ASSIGN_ELEM);
                 if (ap->namarr.flags & ARRAY_TREE) {
                     char *cp;
                     Namval_t *mp;
@@ -1034,17 +1352,18 @@ Namval_t *nv_putsub(Namval_t *np, char *sp, long size, nvflag_t flags) {
                     nv_arraychild(np, mp, 0);
                     nv_setvtree(mp);
                 } else {
-                    STORE_VT(ap->val[size], const_cp, Empty);
+                    STORE_VTP(array_slot(ap, size), const_cp, Empty);
                 }
                 if (!sp && !array_covered(np, ap)) ap->namarr.nelem++;
-                array_clrbit(ap->bits, size, ARRAY_UNSET);
+                array_clrbit(ap, size, ARRAY_UNSET);
             }
         } else if (!(flags & ARRAY_SCAN)) {
             ap->namarr.flags &= ~ARRAY_SCAN;
-            if (array_isbit(ap->bits, size, ARRAY_CHILD) && FETCH_VT(ap->val[size], np)) {
-                nv_putsub(FETCH_VT(ap->val[size], np), NULL, 0, ARRAY_UNDEF);
+            const struct Value *vp = array_peek(ap, size);
+            if (array_isbit(ap, size, ARRAY_CHILD) && FETCH_VTP(vp, np)) {
+                nv_putsub(FETCH_VTP(vp, np), NULL, 0, ARRAY_UNDEF);
             }
-            if (sp && !(flags & ARRAY_ADD) && !FETCH_VT(ap->val[size], const_cp)) np = NULL;
+            if (sp && !(flags & ARRAY_ADD) && !FETCH_VTP(vp, const_cp)) np = NULL;
         }
         return np;
     }
@@ -1120,8 +1439,8 @@ Namval_t *nv_opensub(Namval_t *np) {
     if (!ap) return NULL;
     if (is_associative(&ap->namarr)) {
         return (*ap->namarr.fun)(np, NULL, ASSOC_OP_CURRENT);
-    } else if (array_isbit(ap->bits, ap->cur, ARRAY_CHILD)) {
-        return FETCH_VT(ap->val[ap->cur], np);
+    } else if (array_isbit(ap, ap->cur, ARRAY_CHILD)) {
+        return FETCH_VTP(array_peek(ap, ap->cur), np);
     }
     return NULL;
 }
@@ -1166,11 +1485,130 @@ int nv_aindex(Namval_t *np) {
     return ((struct index_array *)(ap))->cur;
 }
 
+//
+// If the current element of indexed array <np> holds a plain string that can be saved and
+// restored by itself, return its subscript and set <val> to its value, NULL if it is unset.
+// Otherwise return -1 and the whole array has to be saved.
+//
+int nv_aisave(Namval_t *np, const char **val) {
+    struct index_array *ap = (struct index_array *)nv_arrayptr(np);
+
+    if (!ap || is_associative(&ap->namarr) || ap->xp || ap->namarr.scope ||
+        (ap->namarr.flags & (ARRAY_SCAN | ARRAY_UNDEF | ARRAY_TREE)) ||
+        np->nvfun != &ap->namarr.namfun || ap->namarr.namfun.next ||
+        nv_isattr(np, ~(NV_ARRAY | NV_NOFREE)) || ap->cur >= ap->maxi ||
+        array_isbit(ap, ap->cur, ARRAY_CHILD)) {
+        return -1;
+    }
+    *val = FETCH_VTP(array_peek(ap, ap->cur), const_cp);
+    return ap->cur;
+}
+
+//
+// Store <val> in element <sub> of indexed array <np>, or unset the element if <val> is NULL,
+// without disciplines or attribute conversions. The array takes over <val>, which is freed if the
+// element can not hold a string. Return the previous value if the array owned it, otherwise NULL.
+//
+char *nv_aiexchange(Namval_t *np, int sub, char *val) {
+    struct index_array *ap = (struct index_array *)nv_arrayptr(np);
+    struct Value *vp;
+    char *cp;
+
+    if (!ap || is_associative(&ap->namarr) || sub >= ap->maxi ||
+        array_isbit(ap, sub, ARRAY_CHILD)) {
+        if (val != Empty) free(val);
+        return NULL;
+    }
+    vp = array_slot(ap, sub);
+    cp = (char *)FETCH_VTP(vp, const_cp);
+    if (val && !cp) {
+        ap->namarr.nelem++;
+    } else if (!val && cp) {
+        ap->namarr.nelem--;
+    }
+    if (cp == Empty || array_isbit(ap, sub, ARRAY_NOFREE)) cp = NULL;
+    array_clrbit(ap, sub, ARRAY_NOFREE);
+    STORE_VTP(vp, const_cp, val);
+    return cp;
+}
+
+//
+// Store the <n> strings in <vals> as elements <sub> through <sub>+<n>-1 of <np> without going
+// through nv_putsub() and nv_putval() for each of them. The array takes over the strings, which
+// must have been allocated with malloc(). This is only done when <np> is unset or is an indexed
+// array of plain strings with no disciplines. Otherwise false is returned and nothing is stored.
+//
+bool nv_aistore(Namval_t *np, int sub, int n, char *vals[]) {
+    struct index_array *ap = (struct index_array *)nv_arrayptr(np);
+    int i, nelem, top = sub + n;
+    bool sparse;
+
+    if (n <= 0 || top >= ARRAY_MAX) return false;
+    if (ap) {
+        if (is_associative(&ap->namarr) || ap->xp || ap->namarr.scope || ap->namarr.table ||
+            (ap->namarr.flags & (ARRAY_SCAN | ARRAY_UNDEF | ARRAY_TREE)) ||
+            np->nvfun != &ap->namarr.namfun || ap->namarr.namfun.next ||
+            nv_isattr(np, ~(NV_ARRAY | NV_NOFREE))) {
+            return false;
+        }
+    } else if (np->nvfun || nv_isattr(np, ~(nvflag_t)0) || !nv_isnull(np)) {
+        return false;
+    }
+    if (!ap || top > ap->maxi) {
+        nelem = (ap ? array_elem(&ap->namarr) : 0) + n;
+        sparse = (ap && ap->sparse) || (top >= ARRAY_SPARSE && top / ARRAY_DENSITY > nelem);
+        ap = array_resize(np, ap, top - 1, sparse);
+    }
+    for (i = 0; i < n; i++) {
+        struct Value *vp = array_slot(ap, sub + i);
+        char *cp = (char *)FETCH_VTP(vp, const_cp);
+        if (!cp) {
+            ap->namarr.nelem++;
+        } else if (cp != Empty && !array_isbit(ap, sub + i, ARRAY_NOFREE)) {
+            free(cp);
+        }
+        *array_bitp(ap, sub + i) = 0;
+        STORE_VTP(vp, const_cp, vals[i]);
+    }
+    if (top > ap->last) ap->last = top;
+    return true;
+}
+
 int nv_arraynsub(Namarr_t *ap) { return array_elem(ap); }
 
+//
+// Return the vector of values of indexed array <np>. A sparse array is first converted to a vector
+// with its elements moved to consecutive subscripts as nv_aipack() would do.
+//
 struct Value *nv_aivec(Namval_t *np, unsigned char **bitp) {
     struct index_array *ap = (struct index_array *)nv_arrayptr(np);
     if (!ap || is_associative(&ap->namarr)) return NULL;
+    if (ap->sparse) {
+        struct index_array *aq = ap;
+        int i, j, n = 0;
+        size_t size;
+        for (i = array_next(aq, 0); i < aq->maxi; i = array_next(aq, i + 1)) {
+            if (FETCH_VTP(array_peek(aq, i), np)) n++;
+        }
+        n = arsize(NULL, n + 1);
+        size = (n - 1) * sizeof(struct Value) + n;
+        ap = calloc(1, sizeof(*ap) + size);
+        ap->namarr = aq->namarr;
+        ap->namarr.namfun.dsize = sizeof(*ap) + size;
+        ap->last = aq->last;
+        ap->maxi = n;
+        ap->bits = (unsigned char *)&ap->val[n];
+        for (i = j = 0; (i = array_next(aq, i)) < aq->maxi; i++) {
+            const struct Value *vp = array_peek(aq, i);
+            if (FETCH_VTP(vp, np)) {
+                ap->bits[j] = array_bits(aq, i);
+                ap->val[j++] = *vp;
+            }
+        }
+        for (; j < n; j++) STORE_VT(ap->val[j], np, NULL);
+        array_setptr(np, aq, ap);
+        array_free(aq);
+    }
     if (bitp) *bitp = ap->bits;
     return ap->val;
 }
@@ -1201,10 +1639,10 @@ int nv_aimax(Namval_t *np) {
         return -1;
     }
     sub = ap->maxi;
-    while (--sub > 0 && !FETCH_VT(ap->val[sub], const_cp)) {
+    while ((sub = array_prev(ap, sub - 1)) > 0 && !FETCH_VTP(array_peek(ap, sub), const_cp)) {
         ;  // empty loop
     }
-    return sub;
+    return sub < 0 ? 0 : sub;
 }
 
 static_fn void *nv_assoc_op_init(Namval_t *np, const char *sp) {
@@ -1273,6 +1711,7 @@ static_fn void *nv_assoc_op_next(Namval_t *np, const char *sp) {
             ap->namarr.scope = dtvnext(ap->namarr.table);
             ap->namarr.table->view = 0;
         }
+        assoc_walk(ap);
         if (!(ap->pos = ap->cur)) ap->pos = dtfirst(ap->namarr.table);
     } else {
         ap->pos = ap->nextpos;
@@ -1330,8 +1769,10 @@ static_fn void *nv_assoc_op_add(Namval_t *np, const char *sp, bool add) {
     if (sp) {
         Shell_t *shp = sh_ptr(np);
         Namval_t *mp = NULL;
+        Namval_t *prev = ap->cur;
         ap->cur = NULL;
         if (sp == (char *)np) return NULL;
+        assoc_rehash(ap, prev, sp);
         nvflag_t type = nv_isattr(np, ~(NV_NOFREE | NV_ARRAY | NV_CHILD | NV_MINIMAL));
         nvflag_t mode = 0;
 
@@ -1365,6 +1806,7 @@ static_fn void *nv_assoc_op_add(Namval_t *np, const char *sp, bool add) {
             Namval_t fake;
             memset(&fake, 0, sizeof(fake));
             fake.nvname = (char *)sp;
+            assoc_walk(ap);
             ap->pos = mp = dtprev(ap->namarr.table, &fake);
             ap->nextpos = dtnext(ap->namarr.table, mp);
         } else if (!mp && *sp && mode == 0) {
@@ -1435,6 +1877,14 @@ void nv_setvec(Namval_t *np, int append, int argc, char *argv[]) {
         }
     }
     if (ap) ap->last = arg0 + argc;
+    if (argc + arg0 >= ARRAY_SPARSE && (!ap || (!ap->sparse && ap->maxi < argc + arg0))) {
+        // The elements are assigned from the highest subscript down so allocate a vector for all
+        // of them now rather than starting with a sparse array.
+        Shell_t *shp = sh_ptr(np);
+        if (shp->subshell) np = sh_assignok(np, 1);
+        ap = array_resize(np, ap, argc + arg0 - 1, false);
+        ap->last = arg0 + argc;
+    }
     while (--argc >= 0) {
         nv_putsub(np, NULL, (long)argc + arg0, ARRAY_FILL | ARRAY_ADD);
         nv_putval(np, argv[argc], 0);
@@ -43,6 +43,7 @@
 #include "argnod.h"
 #include "ast.h"
 #include "ast_assert.h"
+#include "ast_regex.h"
 #include "cdt.h"
 #include "defs.h"
 #include "edit.h"
@@ -174,7 +175,7 @@ static int rand_shift;
 
 static_fn void env_init(Shell_t *);
 static_fn Init_t *nv_init(Shell_t *);
-static_fn Dt_t *inittree(Shell_t *, const struct shtable2 *);
+static_fn Dt_t *inittree(Shell_t *, const struct shtable2 *, const unsigned short *);
 
 //
 // Invalidate all path name bindings.
@@ -1422,7 +1423,8 @@ int sh_reinit(Shell_t *shp, char *argv[]) {
         nv_delete(np, dp, NV_NOFREE);
     }
     dtclose(shp->alias_tree);
-    shp->alias_tree = inittree(shp, shtab_aliases);
+    shp->alias_tree = inittree(shp, shtab_aliases, shtab_aliases_order);
+    shp->aliasgen++;
     shp->last_root = shp->var_tree;
     shp->inuse_bits = 0;
     if (shp->userinit) (*shp->userinit)(shp, 1);
@@ -1632,14 +1634,61 @@ static_fn void stat_init(Shell_t *shp) {
     struct Svars *sp;
     int i, n;
     n = svar_init(shp, SH_STATS, shtab_stats, 0);
-    shgd->stats = calloc(sizeof(int), n + 1);
-    sp = (struct Svars *)SH_STATS->nvfun->next;
+    sp = (struct Svars *)nv_hasdisc(SH_STATS, &svar_disc);
     sp->data = shgd->stats;
     sp->dsize = (n + 1) * sizeof(shgd->stats[0]);
     for (i = 0; i < n; i++) {
         np = nv_namptr(sp->nodes, i);
         STORE_VT(np->nvalue, ip, &shgd->stats[i]);
     }
+    STORE_VT(nv_namptr(sp->nodes, STAT_REGHITS)->nvalue, ip, &regcachestat()->hits);
+    STORE_VT(nv_namptr(sp->nodes, STAT_REGMISSES)->nvalue, ip, &regcachestat()->misses);
+}
+
+//
+// The .sh.stats compound variable is made when it is first referenced. Until then the counters are
+// kept without it, and it is an empty compound variable with this discipline, which makes the
+// members the first time one is looked up or they are listed.
+//
+static_fn Namfun_t *stat_lazy(void) {
+    Namval_t *np = SH_STATS;
+    Shell_t *shp = sh_ptr(np);
+    Namfun_t *fp = nv_hasdisc(np, &svar_disc);
+    if (!fp) {
+        // Do not let a subshell undo it when it returns.
+        int subshell = shp->subshell;
+        shp->subshell = 0;
+        stat_init(shp);
+        shp->subshell = subshell;
+        // A walk that has started goes on calling this discipline, so it stays ahead of the new one.
+        fp = nv_disc(np, nv_hasdisc(np, &svar_disc), DISC_OP_POP);
+        nv_disc(np, fp, DISC_OP_LAST);
+    }
+    return fp;
+}
+
+static_fn Namval_t *create_stat(Namval_t *np, const void *name, nvflag_t flags, Namfun_t *fp) {
+    Namfun_t *sp = stat_lazy();
+    Namval_t *nq = create_svar(np, name, flags, sp);
+    fp->last = sp->last;
+    return nq;
+}
+
+// The walk passes the previous member rather than .sh.stats once it has started.
+static_fn Namval_t *next_stat(Namval_t *np, Dt_t *root, Namfun_t *fp) {
+    UNUSED(fp);
+    return next_svar(np, root, stat_lazy());
+}
+
+static const Namdisc_t stat_disc = {.dsize = 0, .createf = create_stat, .nextf = next_stat};
+static Namfun_t stat_fun = {.disc = &stat_disc, .nofree = 1, .dsize = sizeof(Namfun_t)};
+
+static_fn void stat_defer(void) {
+    int n = 0;
+    while (*shtab_stats[n].sh_name) n++;
+    shgd->stats = calloc(sizeof(int), n + 1);
+    nv_stack(SH_STATS, &stat_fun);
+    nv_setvtree(SH_STATS);
 }
 
 #define SIGNAME_MAX 32
@@ -1716,7 +1765,7 @@ static_fn Init_t *nv_init(Shell_t *shp) {
     if (!ip) return NULL;
     shp->nvfun.last = (char *)shp;
     shp->nvfun.nofree = 1;
-    shp->var_base = shp->var_tree = inittree(shp, shtab_variables);
+    shp->var_base = shp->var_tree = inittree(shp, shtab_variables, shtab_variables_order);
     STORE_VT(SHLVL->nvalue, ip, &shlvl);
     ip->IFS_init.namfun.disc = &IFS_disc;
     ip->PATH_init.disc = &RESTRICTED_disc;
@@ -1812,11 +1861,11 @@ static_fn Init_t *nv_init(Shell_t *shp) {
     STORE_VT((MCHKNOD)->nvalue, i32p, &sh_mailchk);
     STORE_VT((OPTINDNOD)->nvalue, i32p, &shp->st.optindex);
     // Set up the seconds clock.
-    shp->alias_tree = inittree(shp, shtab_aliases);
+    shp->alias_tree = inittree(shp, shtab_aliases, shtab_aliases_order);
     dtuserdata(shp->alias_tree, shp, 1);
     shp->track_tree = dtopen(&_Nvdisc, Dtset);
     dtuserdata(shp->track_tree, shp, 1);
-    shp->bltin_tree = inittree(shp, (const struct shtable2 *)shtab_builtins);
+    shp->bltin_tree = inittree(shp, (const struct shtable2 *)shtab_builtins, shtab_builtins_order);
     dtuserdata(shp->bltin_tree, shp, 1);
     shp->fun_tree = dtopen(&_Nvdisc, Dtoset);
     dtuserdata(shp->fun_tree, shp, 1);
@@ -1834,24 +1883,30 @@ static_fn Init_t *nv_init(Shell_t *shp) {
     nrp->table = DOTSHNOD;
     nv_onattr(VERSIONNOD, NV_REF);
     math_init(shp);
-    if (!shgd->stats) stat_init(shp);
+    if (!shgd->stats) stat_defer();
     siginfo_init(shp);
     return ip;
 }
 
 //
-// Initialize name-value pairs.
+// Initialize name-value pairs. The nodes are put in their trees in the order given by <order>, a
+// list of runs that each have a count, the index + 1 of the table entry whose dictionary the run
+// is in or 0 for the base tree, and the indexes of the nodes in ascending order of their names.
+// If <order> does not cover the table they are inserted one at a time.
 //
-static_fn Dt_t *inittree(Shell_t *shp, const struct shtable2 *name_vals) {
-    Namval_t *np;
+static_fn Dt_t *inittree(Shell_t *shp, const struct shtable2 *name_vals,
+                         const unsigned short *order) {
+    Namval_t *np, *nodes, *list;
     const struct shtable2 *tp;
-    unsigned n = 0;
+    const unsigned short *op;
+    unsigned n = 0, m = 0;
     Dt_t *treep;
     Dt_t *base_treep;
     Dt_t *dict = NULL;
 
     for (tp = name_vals; *tp->sh_name; tp++) n++;
-    np = calloc(n, sizeof(Namval_t));
+    for (op = order; *op; op += *op + 2) m += *op;
+    nodes = np = calloc(n, sizeof(Namval_t));
     if (!shgd->bltin_nodes) {
         shgd->bltin_nodes = np;
         shgd->bltin_nnodes = n;
@@ -1884,12 +1939,23 @@ static_fn Dt_t *inittree(Shell_t *shp, const struct shtable2 *name_vals) {
         if (nv_isattr(np, NV_TABLE)) {
             dict = dtopen(&_Nvdisc, Dtoset);
             nv_mount(np, NULL, dict);
-            dtinsert(treep, np);
+            if (m != n) dtinsert(treep, np);
             treep = dict;
-        } else {
+        } else if (m != n) {
             dtinsert(treep, np);
         }
     }
+    if (m == n) {
+        for (op = order; *op; op += *op + 2) {
+            list = NULL;
+            for (m = *op; m > 0; m--) {
+                np = nodes + op[m + 1];
+                np->nvlink.rh.__rght = (Dtlink_t *)list;
+                list = np;
+            }
+            dtrestore(op[1] ? nv_dict(nodes + op[1] - 1) : base_treep, (Dtlink_t *)list);
+        }
+    }
     // The loop above has to run at least one interation otherwise this leaks memory pointed to by
     // `np`. Hopefully this assert silences Coverity Scan CID#253829.
     assert(tp != name_vals);
@@ -52,6 +52,7 @@
 #include "name.h"
 #include "path.h"
 #include "sfio.h"
+#include "stk.h"
 #include "terminal.h"
 #include "variables.h"
 
@@ -62,11 +63,16 @@
 #define NJOB_SAVELIST 4
 
 //
-// This struct saves a link list of processes that have non-zero exit status,
-// have had $! saved, but haven't been waited for.
+// This struct saves the exit status of processes that have non-zero exit status,
+// have had $! saved, but haven't been waited for. Each subshell level keeps them
+// in a ring, newest first, bounded by CHILD_MAX, and all of them are also hashed
+// by pid so that wait and job_post() find a saved status without a list walk.
 //
 struct jobsave {
-    struct jobsave *next;
+    struct jobsave *next;    // next in pid hash bucket or on the free list
+    struct jobsave *older;   // next older status of this level
+    struct jobsave *newer;   // next newer status, the oldest for the newest
+    struct back_save *bp;    // level that saved it
     pid_t pid;
     unsigned short exitval;
     unsigned short env;
@@ -109,7 +115,7 @@ static_fn void init_savelist(void) {
 
 struct back_save {
     int count;
-    struct jobsave *list;
+    struct jobsave *list;  // newest saved status
     struct back_save *prev;
 };
 
@@ -161,7 +167,33 @@ static struct process dummy;
 static char by_number;
 static Sfio_t *outfile;
 static pid_t lastpid;
-static struct back_save bck;
+static struct back_save bck0;
+static struct back_save *bck = &bck0;
+static struct process **pidtab;  // processes hashed by pid
+static struct process **jidtab;  // first process of each job by job number
+static struct jobsave **savetab;  // saved statuses hashed by pid
+static unsigned int pidmask;
+static unsigned int pidcount;  // processes in pidtab
+static unsigned int savecount;  // statuses in savetab
+static int jidmax;
+
+//
+// Background jobs and coprocesses are queued here by job_reap() as they complete so that
+// `wait -n` can return them in order. When more than CHILD_MAX are pending the oldest are
+// dropped; their exit status is still saved for `wait pid`.
+//
+struct jobdone {
+    pid_t pid;  // 0 once the entry has been consumed
+    long env;
+};
+
+static struct jobdone *doneq;
+static unsigned int donefirst;
+static unsigned int donelast;
+static unsigned int donemask;
+
+#define pidslot(pid) ((unsigned int)(pid)&pidmask)
+#define PIDTAB_MIN 64  // initial number of pidtab and savetab slots
 
 #ifdef JOBS
 static_fn void job_set(struct process *);
@@ -241,14 +273,86 @@ void job_chldtrap(Shell_t *shp, const char *trap, int lock) {
     job_unlock();
 }
 
+//
+// Double the number of pidtab and savetab slots. Each chain splits in two and keeps its order so
+// that the most recently posted of two processes with the same pid is still found first.
+//
+static_fn void pidtab_grow(void) {
+    unsigned int i, size = 2 * (pidmask + 1);
+    struct process **ptab, **plo, **phi, *pw;
+    struct jobsave **stab, **slo, **shi, *jp;
+
+    ptab = calloc(size, sizeof(struct process *));
+    stab = calloc(size, sizeof(struct jobsave *));
+    if (!ptab || !stab) {
+        free(ptab);
+        free(stab);
+        return;
+    }
+    for (i = 0; i <= pidmask; i++) {
+        plo = &ptab[i];
+        phi = &ptab[i + pidmask + 1];
+        for (pw = pidtab[i]; pw; pw = pw->p_nxtpid) {
+            if ((unsigned int)pw->p_pid & (pidmask + 1)) {
+                *phi = pw;
+                phi = &pw->p_nxtpid;
+            } else {
+                *plo = pw;
+                plo = &pw->p_nxtpid;
+            }
+        }
+        *plo = *phi = NULL;
+        slo = &stab[i];
+        shi = &stab[i + pidmask + 1];
+        for (jp = savetab[i]; jp; jp = jp->next) {
+            if ((unsigned int)jp->pid & (pidmask + 1)) {
+                *shi = jp;
+                shi = &jp->next;
+            } else {
+                *slo = jp;
+                slo = &jp->next;
+            }
+        }
+        *slo = *shi = NULL;
+    }
+    free(pidtab);
+    free(savetab);
+    pidtab = ptab;
+    savetab = stab;
+    pidmask = size - 1;
+}
+
+//
+// Remove saved status <jp> from its ring and from the pid hash.
+//
+static_fn void jobsave_unlink(struct jobsave *jp) {
+    struct back_save *bp = jp->bp;
+    struct jobsave **jpp;
+
+    for (jpp = &savetab[pidslot(jp->pid)]; *jpp != jp; jpp = &(*jpp)->next) {
+        ;  // empty loop
+    }
+    *jpp = jp->next;
+    savecount--;
+    if (jp->older == jp) {
+        bp->list = NULL;
+    } else {
+        jp->newer->older = jp->older;
+        jp->older->newer = jp->newer;
+        if (bp->list == jp) bp->list = jp->older;
+    }
+    bp->count--;
+}
+
 //
 // Return next on link list of jobsave free list.
 //
 static_fn struct jobsave *jobsave_create(pid_t pid) {
-    struct jobsave *jp = job_savelist;
+    struct jobsave *jp, *newest;
 
     job_chksave(pid, -1);
-    if (++bck.count > shgd->lim.child_max) job_chksave(0, -1);
+    if (bck->count >= shgd->lim.child_max) job_chksave(0, -1);
+    jp = job_savelist;
     if (jp) {
         njob_savelist--;
         job_savelist = jp->next;
@@ -257,9 +361,22 @@ static_fn struct jobsave *jobsave_create(pid_t pid) {
     }
     if (jp) {
         jp->pid = pid;
-        jp->next = bck.list;
-        bck.list = jp;
         jp->exitval = 0;
+        jp->bp = bck;
+        if (savecount++ > pidmask) pidtab_grow();
+        jp->next = savetab[pidslot(pid)];
+        savetab[pidslot(pid)] = jp;
+        newest = bck->list;
+        if (newest) {
+            jp->older = newest;
+            jp->newer = newest->newer;
+            newest->newer->older = jp;
+            newest->newer = jp;
+        } else {
+            jp->older = jp->newer = jp;
+        }
+        bck->list = jp;
+        bck->count++;
     }
     return jp;
 }
@@ -536,6 +653,13 @@ bool job_reap(int sig) {
                 pw->p_exit = pw->p_exitmin;
                 if (WEXITSTATUS(wstat) > pw->p_exitmin) pw->p_exit = WEXITSTATUS(wstat);
             }
+            if (pw != &dummy && ((pw->p_flag & P_BG) || pid == shp->cpid)) {
+                struct jobdone *dp;
+                if (donelast - donefirst > donemask) donefirst++;
+                dp = &doneq[donelast++ & donemask];
+                dp->pid = pid;
+                dp->env = pw->p_env;
+            }
             if ((pw->p_flag & P_DONE) && (pw->p_flag & P_BG)) {
                 if (shp->st.trapcom[SIGCHLD]) {
                     shp->sigflag[SIGCHLD] = SH_SIGTRAP;
@@ -792,42 +916,126 @@ static_fn void job_reset(struct process *pw) {
 #endif  // JOBS
 
 //
-// `wait` built-in command.
+// Set <pid> to the process id named by `wait` operand <jp>. Return false if there is no such job.
 //
-void job_bwait(char **jobs) {
-    char *jp;
-    struct process *pw;
+static_fn bool job_bwaitpid(char *jp, pid_t *pid) {
+#ifdef JOBS
+    if (*jp == '%') {
+        struct process *pw;
+        job_lock();
+        pw = job_bystring(jp);
+        job_unlock();
+        if (!pw) return false;
+        *pid = pw->p_pid;
+        return true;
+    }
+#endif  // JOBS
+    *pid = pid_fromstring(jp);
+    return true;
+}
+
+//
+// Wait for the first of the <npids> processes in <pids> to complete, or for any background job
+// or coprocess when <pids> is NULL, and return its pid. Jobs that have already completed are
+// returned first, oldest first. Return 0 with exit status 127 if there is nothing to wait for.
+//
+static_fn pid_t job_waitany(Shell_t *shp, pid_t *pids, int npids) {
+    struct jobdone *dp;
+    struct process *pw, *px;
+    unsigned int i;
     pid_t pid;
+    int n;
+    bool nochild = false;
 
-    if (*jobs == 0) {
-        job_wait((pid_t)-1);
-    } else {
-        while (*jobs) {
-            jp = *jobs++;
-#ifdef JOBS
-            if (*jp == '%') {
-                job_lock();
-                pw = job_bystring(jp);
-                job_unlock();
-                if (pw) {
-                    pid = pw->p_pid;
-                } else {
-                    return;
+    job_lock();
+    while (1) {
+        while (donefirst != donelast && !doneq[donefirst & donemask].pid) donefirst++;
+        for (i = donefirst; i != donelast; i++) {
+            dp = &doneq[i & donemask];
+            if (!dp->pid || dp->env != shp->curenv) continue;
+            for (n = 0; n < npids && pids[n] != dp->pid; n++) {
+                ;  // empty loop
+            }
+            if (pids && n == npids) continue;
+            pid = dp->pid;
+            dp->pid = 0;
+            if ((pw = job_bypid(pid))) {
+                // A pid that has been reused by a job that is still running.
+                if (!(pw->p_flag & P_DONE)) continue;
+            } else {
+                struct jobsave *jp;
+                for (jp = savetab[pidslot(pid)]; jp && jp->pid != pid; jp = jp->next) {
+                    ;  // empty loop
                 }
+                // Already waited for by pid.
+                if (!jp || jp->env != shp->curenv) continue;
             }
-#if SHOPT_COSHELL
-            else if (isalpha(*jp)) {
-                job_cowalk(NULL, 0, jp);
-                return;
+            job_unlock();
+            job_wait(-pid);
+            return pid;
+        }
+        if (nochild || (shp->trapnote & (SH_SIGSET | SH_SIGTRAP))) break;
+        // Only sleep if a job that can be waited for is still running.
+        for (pw = job.pwlist; pw; pw = pw->p_nxtjob) {
+            if (pw->p_env != shp->curenv) continue;
+            for (n = 0; n < npids && pids[n] != pw->p_pid; n++) {
+                ;  // empty loop
             }
-#endif  // SHOPT_COSHELL
-            else {
-#endif  // JOBS
-                pid = pid_fromstring(jp);
+            if (pids && n == npids) continue;
+            for (px = pw; px && (px->p_flag & P_DONE); px = px->p_nxtproc) {
+                ;  // empty loop
             }
-            job_wait(-pid);
+            if (px) break;
         }
+        if (!pw) break;
+        job.waitsafe = 0;
+        nochild = job_reap(job.savesig);
     }
+    job_unlock();
+    shp->exitval = (shp->trapnote & (SH_SIGSET | SH_SIGTRAP)) ? 1 : ERROR_NOENT;
+    exitset(shp);
+    return 0;
+}
+
+//
+// `wait` built-in command. Return the pid whose exit status is the exit status of `wait`, or 0.
+// If <any> is set, wait for only the first of <jobs> to complete.
+//
+pid_t job_bwait(char **jobs, bool any) {
+    Shell_t *shp = sh_getinterp();
+    char *jp;
+    pid_t pid = 0;
+    pid_t *pids = NULL;
+    int n = 0;
+
+    if (any) {
+        if (*jobs) {
+            for (n = 0; jobs[n]; n++) {
+                ;  // empty loop
+            }
+            pids = stkalloc(shp->stk, n * sizeof(pid_t));
+            for (n = 0; (jp = *jobs); jobs++) {
+                if (job_bwaitpid(jp, &pid)) pids[n++] = pid;
+            }
+        }
+        return job_waitany(shp, pids, n);
+    }
+    if (*jobs == 0) {
+        job_wait((pid_t)-1);
+        return 0;
+    }
+    while (*jobs) {
+        jp = *jobs++;
+#if SHOPT_COSHELL
+        if (isalpha(*jp)) {
+            job_cowalk(NULL, 0, jp);
+            return 0;
+        }
+#endif  // SHOPT_COSHELL
+        if (!job_bwaitpid(jp, &pid)) return 0;
+        job_wait(-pid);
+    }
+    return pid;
 }
 
 #ifdef JOBS
@@ -1182,22 +1390,40 @@ void job_clear(Shell_t *shp) {
     struct process *pw, *px;
     struct process *pwnext;
     int j = BYTE(shp->gd->lim.child_max);
-    struct jobsave *jp, *jpnext;
+    struct jobsave *jp;
 
     job_lock();
+    if (!job.freejobs) {
+        job.freejobs = malloc(j + 1);
+        jidmax = j * CHAR_BIT;
+        jidtab = calloc(jidmax + 1, sizeof(struct process *));
+        // The pid hash tables start small and grow with the number of processes since zeroing
+        // tables sized for CHILD_MAX is a noticeable part of the startup time.
+        pidtab = calloc(PIDTAB_MIN, sizeof(struct process *));
+        savetab = calloc(PIDTAB_MIN, sizeof(struct jobsave *));
+        pidmask = PIDTAB_MIN - 1;
+        for (donemask = 64; donemask < shp->gd->lim.child_max; donemask <<= 1) {
+            ;  // empty loop
+        }
+        doneq = calloc(donemask, sizeof(struct jobdone));
+        donemask--;
+    }
+    donefirst = donelast = 0;
     for (pw = job.pwlist; pw; pw = pwnext) {
         pwnext = pw->p_nxtjob;
+        jidtab[pw->p_job] = NULL;
         while (pw) {
             px = pw;
             pw = pw->p_nxtproc;
+            pidtab[pidslot(px->p_pid)] = NULL;
             free(px);
         }
     }
-    for (jp = bck.list; jp; jp = jpnext) {
-        jpnext = jp->next;
+    pidcount = 0;
+    while ((jp = bck->list)) {
+        jobsave_unlink(jp);
         free(jp);
     }
-    bck.list = 0;
     if (njob_savelist < NJOB_SAVELIST) init_savelist();
     job.pwlist = NULL;
     job.numpost = 0;
@@ -1205,7 +1431,6 @@ void job_clear(Shell_t *shp) {
     job.waitall = 0;
     job.curpgid = 0;
     job.toclear = 0;
-    if (!job.freejobs) job.freejobs = malloc(j + 1);
     while (j >= 0) job.freejobs[j--] = 0;
     job_unlock();
 }
@@ -1333,6 +1558,10 @@ int job_post(Shell_t *shp, pid_t pid, pid_t join) {
         pw->p_curdir = path_pwd(shp);
         if (pw->p_curdir) pw->p_curdir = strdup(pw->p_curdir);
     }
+    jidtab[pw->p_job] = pw;
+    if (pidcount++ > pidmask) pidtab_grow();
+    pw->p_nxtpid = pidtab[pidslot(pid)];
+    pidtab[pidslot(pid)] = pw;
     job_unlock();
     return pw->p_job;
 }
@@ -1341,24 +1570,19 @@ int job_post(Shell_t *shp, pid_t pid, pid_t join) {
 // Returns a process structure give a process id.
 //
 static_fn struct process *job_bypid(pid_t pid) {
-    struct process *pw, *px;
-    for (pw = job.pwlist; pw; pw = pw->p_nxtjob) {
-        for (px = pw; px; px = px->p_nxtproc) {
-            if (px->p_pid == pid) return px;
-        }
+    struct process *pw;
+    for (pw = pidtab[pidslot(pid)]; pw; pw = pw->p_nxtpid) {
+        if (pw->p_pid == pid) break;
     }
-    return NULL;
+    return pw;
 }
 
 //
 // Return a pointer to a job given the job id.
 //
 static_fn struct process *job_byjid(int jobid) {
-    struct process *pw;
-    for (pw = job.pwlist; pw; pw = pw->p_nxtjob) {
-        if (pw->p_job == jobid) break;
-    }
-    return pw;
+    if (jobid <= 0 || jobid > jidmax) return NULL;
+    return jidtab[jobid];
 }
 
 //
@@ -1659,7 +1883,16 @@ static_fn struct process *job_unpost(Shell_t *shp, struct process *pwtop, int no
     if (!pwtop || pwtop->p_job == job.curjobid) return NULL;
     // All processes complete, unpost job.
     job_unlink(pwtop);
+    jidtab[pwtop->p_job] = NULL;
     for (pw = pwtop; pw; pw = pw->p_nxtproc) {
+        struct process **ppw;
+        for (ppw = &pidtab[pidslot(pw->p_pid)]; *ppw && *ppw != pw; ppw = &(*ppw)->p_nxtpid) {
+            ;  // empty loop
+        }
+        if (*ppw) {
+            *ppw = pw->p_nxtpid;
+            pidcount--;
+        }
         if (pw && pw->p_exitval) *pw->p_exitval = pw->p_exit;
         // Save the exit status for background jobs.
         if ((pw->p_flag & P_EXITSAVE) || pw->p_pid == shp->spid) {
@@ -1777,24 +2010,15 @@ static_fn const char *job_sigmsg(Shell_t *shp, int sig) {
 // If pid is not found a -1 is returned.
 //
 static_fn int job_chksave(pid_t pid, long env) {
-    struct jobsave *jp = bck.list;
-    struct jobsave *jpold = NULL;
+    struct jobsave *jp;
     int r = -1;
-    int count = bck.count;
-    struct back_save *bp = &bck;
 
-again:
-    while (jp && count-- > 0) {
-        if (jp->pid == pid) break;
-        if (pid == 0 && !jp->next) break;
-        jpold = jp;
-        jp = jp->next;
-    }
-    if (!jp && pid && (bp = bp->prev)) {
-        count = bp->count;
-        jp = bp->list;
-        jpold = NULL;
-        goto again;
+    if (pid) {
+        for (jp = savetab[pidslot(pid)]; jp; jp = jp->next) {
+            if (jp->pid == pid) break;
+        }
+    } else {
+        jp = bck->list ? bck->list->newer : NULL;
     }
 
     if (!jp) return r;
@@ -1802,12 +2026,7 @@ again:
 
     r = 0;
     if (pid) r = jp->exitval;
-    if (jpold) {
-        jpold->next = jp->next;
-    } else {
-        bp->list = jp->next;
-    }
-    bp->count--;
+    jobsave_unlink(jp);
     if (njob_savelist < NJOB_SAVELIST) {
         njob_savelist++;
         jp->next = job_savelist;
@@ -1821,35 +2040,37 @@ again:
 void *job_subsave(void) {
     struct back_save *bp = calloc(1, sizeof(struct back_save));
     job_lock();
-    *bp = bck;
-    bp->prev = bck.prev;
-    bck.count = 0;
-    bck.list = 0;
-    bck.prev = bp;
+    bp->prev = bck;
+    bck = bp;
     job_unlock();
     return bp;
 }
 
 void job_subrestore(Shell_t *shp, void *ptr) {
-    struct jobsave *jp, *jpnext;
+    struct jobsave *jp, *oldest;
     struct back_save *bp = (struct back_save *)ptr;
+    struct back_save *prev = bp->prev;
     struct process *pw, *px, *pwnext;
-    struct jobsave *end = NULL;
-    int i = 0;
 
     job_lock();
-    for (jp = bck.list; jp; jp = jpnext, i++) {
-        if (!(jpnext = jp->next) || jp == jpnext) end = jp;
-        if (i >= shgd->lim.child_max) break;
-    }
-    if (end) {
-        end->next = bp->list;
-    } else {
-        bck.list = bp->list;
+    // The statuses saved by the subshell become the newest of the enclosing level.
+    jp = bp->list;
+    if (jp) {
+        do {
+            jp->bp = prev;
+        } while ((jp = jp->older) != bp->list);
+        if (prev->list) {
+            oldest = jp->newer;
+            oldest->older = prev->list;
+            jp->newer = prev->list->newer;
+            prev->list->newer->older = jp;
+            prev->list->newer = oldest;
+        }
+        prev->list = jp;
     }
-    bck.count += bp->count;
-    bck.prev = bp->prev;
-    while (bck.count > shgd->lim.child_max) job_chksave(0, -1);
+    prev->count += bp->count;
+    bck = prev;
+    while (bck->count > shgd->lim.child_max) job_chksave(0, -1);
     for (pw = job.pwlist; pw; pw = pwnext) {
         pwnext = pw->p_nxtjob;
         if (pw->p_env != shp->curenv || pw->p_pid == shp->pipepid) continue;
@@ -1042,7 +1042,7 @@ static_fn bool varsub(Mac_t *mp) {
     int dolg = 0, mode = 0;
     Lex_t *lp = mp->shp->lex_context;
     Namarr_t *ap = NULL;
-    int dolmax = 0, vsize = -1, offset = -1, nulflg, replen = 0, bysub = 0;
+    int dolmax = 0, vsize = -1, vlen = -1, offset = -1, nulflg, replen = 0, bysub = 0;
     char idbuff[3], *id = idbuff, *pattern = NULL, *repstr = NULL, *arrmax = NULL;
     char *idx = NULL;
     int d, var = 1, addsub = 0, oldpat = mp->pattern, idnum = 0;
@@ -1384,6 +1384,11 @@ retry1:
                         }
                     } else {
                         v = nv_getval(np);
+                        // Use the length nv_putval() recorded rather than scanning the string.
+                        if (type == M_SIZE && !ap && v && v == FETCH_VT(np->nvalue, const_cp) &&
+                            np->nvalue.scap && (!mbwide() || (np->nvalue.scap & VALUE_ASCII))) {
+                            vlen = np->nvalue.slen;
+                        }
                     }
                     mp->atmode = (v && mp->quoted && mode == '@');
                     // Special case --- ignore leading zeros.
@@ -1471,7 +1476,7 @@ retry1:
             goto skip;
         } else {
             if (!isastchar(mode)) {
-                c = charlen(v, vsize);
+                c = vlen >= 0 ? vlen : charlen(v, vsize);
             } else if (dolg > 0) {
                 if (mp->shp->cur_line) {
                     getdolarg(mp->shp, MAX_ARGN, NULL);
@@ -1891,12 +1896,120 @@ nosub:
     return false;
 }
 
+//
+// The parse trees of `...` command substitutions are cached so that one executed in a loop is only
+// parsed once. An entry is keyed by the text of the command and by where it appears, since the
+// line numbers in the tree depend on it, and by the aliases and options that change the parse.
+// Each tree lives on its own stack like a function body; functions defined inside it keep theirs
+// on the entry's stack list until the entry is evicted.
+//
+#define BQCACHE 64  // must be a power of 2 and not zero
+
+struct bqtree {
+    char *text;
+    int size;
+    int line;
+    int firstline;
+    int opts;
+    unsigned int aliasgen;
+    int busy;  // number of active executions of tree
+    const char *filename;
+    Stk_t *stk;
+    struct slnod *staklist;
+    Shnode_t *tree;
+};
+
+static struct bqtree bqcache[BQCACHE];
+
+//
+// Return the options and states that the parse depends on, or -1 when the parse has side effects
+// so that its tree must not be reused.
+//
+static_fn int bq_options(Shell_t *shp) {
+    int opts = 0;
+
+    if (sh_isoption(shp, SH_VERBOSE) || sh_isoption(shp, SH_NOEXEC) ||
+        sh_isoption(shp, SH_DICTIONARY) || shp->lex_context->kiafile) {
+        return -1;
+    }
+    if (sh_isoption(shp, SH_POSIX)) opts |= 1;
+    if (sh_isoption(shp, SH_BASH)) opts |= 2;
+    if (sh_isoption(shp, SH_BRACEEXPAND)) opts |= 4;
+    if (sh_isoption(shp, SH_KEYWORD)) opts |= 8;
+    if (sh_isstate(shp, SH_PROFILE)) opts |= 16;
+    if (sh_isstate(shp, SH_NOALIAS)) opts |= 32;
+    return opts;
+}
+
+static_fn void bq_free(struct bqtree *bp) {
+    if (bp->staklist) sh_funstaks(bp->staklist, -1);
+    if (bp->stk) stkclose(bp->stk);
+    memset(bp, 0, sizeof(*bp));
+}
+
+//
+// Return the parse tree for the <size> bytes of command text at <str>, parsing it if it is not
+// in the cache. NULL is returned when the tree cannot be cached.
+//
+static_fn struct bqtree *bq_tree(Shell_t *shp, char *str, int size) {
+    struct bqtree *bp;
+    Stk_t *savstk;
+    Sfio_t *sp;
+    checkpt_t buff;
+    int jmpval, opts = bq_options(shp);
+    int line = error_info.line;
+    const char *filename = shp->st.filename ? shp->st.filename : "";
+
+    if (opts < 0) return NULL;
+    bp = &bqcache[(dtstrhash(line, str, size) ^ shp->st.firstline) & (BQCACHE - 1)];
+    if (bp->tree && bp->size == size && bp->line == line && bp->firstline == shp->st.firstline &&
+        bp->opts == opts && bp->aliasgen == shp->aliasgen && memcmp(bp->text, str, size) == 0 &&
+        strcmp(bp->filename, filename) == 0) {
+        sh_stats(STAT_COMSUBHITS);
+        // Do what sh_parse() would have done.
+        if (sh_isoption(shp, SH_INTERACTIVE)) sh_onstate(shp, SH_INTERACTIVE);
+        return bp;
+    }
+    if (bp->busy) return NULL;
+    bq_free(bp);
+    sp = sfnew(NULL, str, size, -1, SF_STRING | SF_READ);
+    savstk = stkinstall(stkopen(STK_SMALL), 0);
+    sh_pushcontext(shp, &buff, 1);
+    jmpval = sigsetjmp(buff.buff, 0);
+    if (jmpval == 0) {
+        bp->tree = sh_parse(shp, sp, SH_EOF | SH_NL);
+        bp->text = stkalloc(stkstd, size);
+        memcpy(bp->text, str, size);
+        bp->filename = stkcopy(stkstd, filename);
+    }
+    sh_popcontext(shp, &buff);
+    bp->stk = stkinstall(savstk, 0);
+    bp->staklist = shp->st.staklist;
+    shp->st.staklist = NULL;
+    sfclose(sp);
+    if (jmpval) {
+        bq_free(bp);
+        siglongjmp(shp->jmplist->buff, jmpval);
+    }
+    if (!bp->tree) {
+        bq_free(bp);
+        return NULL;
+    }
+    bp->size = size;
+    bp->line = line;
+    bp->firstline = shp->st.firstline;
+    bp->opts = opts;
+    bp->aliasgen = shp->aliasgen;
+    return bp;
+}
+
 //
 // This routine handles command substitution.
 // <type> is 0 for older `...` version.
 //
 static_fn void comsubst(Mac_t *mp, Shnode_t *t, volatile int type) {
     Sfdouble_t num;
+    bool isint = false;
     int c;
     char *str;
     Sfio_t *sp;
@@ -1909,10 +2022,11 @@ static_fn void comsubst(Mac_t *mp, Shnode_t *t, volatile int type) {
     int was_history = sh_isstate(mp->shp, SH_HISTORY);
     int was_verbose = sh_isstate(mp->shp, SH_VERBOSE);
     int was_interactive = sh_isstate(mp->shp, SH_INTERACTIVE);
-    int newlines, bufsize, nextnewlines;
+    int newlines, bufsize, nextnewlines, savline;
     Sfoff_t foff;
     Namval_t *np;
     pid_t spid;
+    struct bqtree *bp = NULL;
 
     mp->shp->argaddr = NULL;
     savemac = *mp;
@@ -1928,7 +2042,7 @@ static_fn void comsubst(Mac_t *mp, Shnode_t *t, volatile int type) {
             mp->shp->inarith = 1;
             fcsave(&save);
             if (t->ar.arcomp) {
-                num = arith_exec(t->ar.arcomp);
+                num = arith_execute(t->ar.arcomp, &isint);
             } else if ((t->ar.arexpr->argflag & ARG_RAW)) {
                 num = sh_arith(mp->shp, t->ar.arexpr->argval);
             } else {
@@ -1938,7 +2052,9 @@ static_fn void comsubst(Mac_t *mp, Shnode_t *t, volatile int type) {
         out_offset:
             stkset(stkp, savptr, savtop);
             *mp = savemac;
-            if (num && (Sfulong_t)num == num) {
+            if (isint) {
+                sfprintf(mp->shp->strbuf, "%lld", (Sflong_t)num);
+            } else if (num && (Sfulong_t)num == num) {
                 sfprintf(mp->shp->strbuf, "%llu", (Sfulong_t)num);
             } else if ((Sflong_t)num != num) {
                 sfprintf(mp->shp->strbuf, "%.*Lg", LDBL_DIG, num);
@@ -1970,11 +2086,17 @@ static_fn void comsubst(Mac_t *mp, Shnode_t *t, volatile int type) {
         sh_offstate(mp->shp, SH_HISTORY);
         sh_offstate(mp->shp, SH_VERBOSE);
         if (mp->sp) sfsync(mp->sp);  // flush before executing command
-        sp = sfnew(NULL, str, c, -1, SF_STRING | SF_READ);
-        c = mp->shp->inlineno;
+        savline = mp->shp->inlineno;
         mp->shp->inlineno = error_info.line + mp->shp->st.firstline;
-        t = sh_parse(mp->shp, sp, SH_EOF | SH_NL);
-        mp->shp->inlineno = c;
+        if ((bp = bq_tree(mp->shp, str, c))) {
+            t = bp->tree;
+            bp->busy++;
+        } else {
+            sp = sfnew(NULL, str, c, -1, SF_STRING | SF_READ);
+            t = sh_parse(mp->shp, sp, SH_EOF | SH_NL);
+            sfclose(sp);
+        }
+        mp->shp->inlineno = savline;
         type = 1;
     }
     if (t) {
@@ -1986,7 +2108,6 @@ static_fn void comsubst(Mac_t *mp, Shnode_t *t, volatile int type) {
             checkpt_t buff;
             struct ionod *ip = NULL;
 
-            if (sp) sfclose(sp);
             sh_pushcontext(mp->shp, &buff, SH_JMPIO);
             if ((ip = t->tre.treio) && ((ip->iofile & IOLSEEK) || !(ip->iofile & IOUFD)) &&
                 (r = sigsetjmp(buff.buff, 0)) == 0) {
@@ -2016,6 +2137,7 @@ static_fn void comsubst(Mac_t *mp, Shnode_t *t, volatile int type) {
     } else {
         sp = sfopen(NULL, "", "sr");
     }
+    if (bp) bp->busy--;
     sh_freeup(mp->shp);
     mp->shp->st.staklist = saveslp;
     if (was_history) sh_onstate(mp->shp, SH_HISTORY);
@@ -0,0 +1,116 @@
+/***********************************************************************
+ *                                                                      *
+ *               This software is part of the ast package               *
+ *          Copyright (c) 1982-2014 AT&T Intellectual Property          *
+ *                      and is licensed under the                       *
+ *                 Eclipse Public License, Version 1.0                  *
+ *                    by AT&T Intellectual Property                     *
+ *                                                                      *
+ *                A copy of the License is available at                 *
+ *          http://www.eclipse.org/org/documents/epl-v10.html           *
+ *         (with md5 checksum b35adb5213ca9657e911e9befb180842)         *
+ *                                                                      *
+ *              Information and Software Systems Research               *
+ *                            AT&T Research                             *
+ *                           Florham Park NJ                            *
+ *                                                                      *
+ *                    David Korn <dgkorn@gmail.com>                     *
+ *                                                                      *
+ ***********************************************************************/
+//
+// Write the order in which the nodes made from the builtin, alias and variable tables are kept in
+// their trees. sh_init() uses it to restore each tree from an ascending list instead of inserting
+// the nodes one at a time. This is run at build time and its output is compiled into libksh.
+//
+#include "config_ast.h"  // IWYU pragma: keep
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "name.h"
+#include "shtable.h"
+
+// This program is linked with the objects of libksh, which refer to the orders it writes. An
+// order with no runs makes inittree() insert the nodes.
+const unsigned short shtab_aliases_order[] = {0};
+const unsigned short shtab_builtins_order[] = {0};
+const unsigned short shtab_variables_order[] = {0};
+
+struct entry {
+    const char *name;
+    int table;  // index + 1 of the entry whose dictionary has the node, 0 for the base tree
+    int index;
+};
+
+static int compare(const void *a, const void *b) {
+    const struct entry *ep = a, *fp = b;
+    int c;
+
+    if (ep->table != fp->table) return ep->table - fp->table;
+    c = strcmp(ep->name, fp->name);
+    return c ? c : ep->index - fp->index;
+}
+
+//
+// Write the order of table <tp> whose entries are <size> bytes apart. The entries are assigned to
+// trees the way inittree() does it.
+//
+static int order(FILE *out, const char *id, const char *tp, size_t size) {
+    const struct shtable2 *sp;
+    struct entry *ep;
+    const char *name;
+    int i, j, n, table = 0;
+
+    for (n = 0; *((const struct shtable2 *)(tp + n * size))->sh_name; n++) {
+        ;  // empty loop
+    }
+    ep = calloc(n, sizeof(struct entry));
+    if (!ep) return -1;
+    for (i = 0; i < n; i++) {
+        sp = (const struct shtable2 *)(tp + i * size);
+        if (!(name = strrchr(sp->sh_name, '.')) || name == sp->sh_name) {
+            name = sp->sh_name;
+            table = 0;
+        } else {
+            name++;
+        }
+        ep[i].name = name;
+        ep[i].table = table;
+        ep[i].index = i;
+        if (sp->sh_number & NV_TABLE) table = i + 1;
+    }
+    qsort(ep, n, sizeof(struct entry), compare);
+
+    // Each run of nodes in one tree is its count, the table it is in, then the node indexes.
+    fprintf(out, "\nconst unsigned short shtab_%s_order[] = {", id);
+    for (i = 0; i < n; i = j) {
+        for (j = i; j < n && ep[j].table == ep[i].table; j++) {
+            ;  // empty loop
+        }
+        fprintf(out, "\n    %d, %d,", j - i, ep[i].table);
+        for (int k = i; k < j; k++) fprintf(out, "%s%d,", (k - i) % 16 ? " " : "\n    ", ep[k].index);
+    }
+    fprintf(out, "\n    0};\n");
+    free(ep);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    FILE *out;
+
+    if (argc != 2 || !(out = fopen(argv[1], "w"))) {
+        fprintf(stderr, "Usage: mktables file\n");
+        return 1;
+    }
+    fprintf(out, "// Generated by mktables. Do not edit.\n");
+    fprintf(out, "#include \"config_ast.h\"  // IWYU pragma: keep\n\n#include \"shtable.h\"\n");
+    if (order(out, "aliases", (const char *)shtab_aliases, sizeof(shtab_aliases[0])) < 0 ||
+        order(out, "builtins", (const char *)shtab_builtins, sizeof(shtab_builtins[0])) < 0 ||
+        order(out, "variables", (const char *)shtab_variables, sizeof(shtab_variables[0])) < 0 ||
+        fclose(out)) {
+        fprintf(stderr, "mktables: cannot write %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
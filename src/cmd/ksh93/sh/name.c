@@ -102,6 +102,7 @@ struct adata {
     char **argnam;
     int attsize;
     char *attval;
+    bool dynamic;  // an exported variable has a get discipline or is an array
 };
 
 struct sh_type {
@@ -129,6 +130,19 @@ struct Namcache {
 };
 static struct Namcache nvcache;
 
+// The environment generated for commands at the global scope is kept until ast.env_serial changes.
+// Exported variables assigned in the meantime are listed by name and patched into it.
+#define ENV_CHANGES 8
+#define ENV_ATTRS (NV_RDONLY | NV_UTOL | NV_LTOU | NV_RJUST | NV_LJUST | NV_ZFILL | NV_INTEGER)
+static struct Envcache {
+    char **envp;                 // cached environment, NULL if none
+    char **old;                  // previous environment, freed when the next one is made
+    uint32_t serial;             // ast.env_serial when envp was generated or patched
+    bool dynamic;                // the list at serial has dynamic values and was not kept
+    int nchanged;                // number of names in changed[]
+    char *changed[ENV_CHANGES];  // variables assigned since envp was generated
+} envcache;
+
 bool nv_local = false;
 
 // ======== name value pair routines ========
@@ -1445,13 +1459,13 @@ void nv_putval(Namval_t *np, const void *vp, nvflag_t flags) {
     }
     // The following could cause the shell to fork if assignment would cause a side effect.
     shp->argaddr = NULL;
-    if (shp->subshell && !nv_local && !(flags & NV_RDONLY)) np = sh_assignok(np, 1);
+    if (shp->subshell && !nv_local && !(flags & NV_RDONLY)) np = sh_assignok(np, SH_ASSIGN_ELEM);
     if (np->nvfun && np->nvfun->disc && !(flags & NV_NODISC) && !nv_isref(np)) {
         // This function contains disc.
         if (!nv_local) {
             nv_local = true;
             nv_putv(np, sp, flags, np->nvfun);
-            if (sp && ((flags & NV_EXPORT) || nv_isattr(np, NV_EXPORT))) sh_envput(shp->env, np);
+            if (sp && ((flags & NV_EXPORT) || nv_isattr(np, NV_EXPORT))) sh_envput(shp, np);
             return;
         }
         // Called from disc, assign the actual value.
@@ -1630,6 +1644,8 @@ void nv_putval(Namval_t *np, const void *vp, nvflag_t flags) {
         char *tofree = NULL;
         int offset = 0;
         int append;
+        size_t cap = 0;
+        uint32_t ascii = 0;
         if (flags & NV_INTEGER) {
             if ((flags & NV_DOUBLE) == NV_DOUBLE) {
                 if (flags & NV_LONG) {
@@ -1731,7 +1747,7 @@ void nv_putval(Namval_t *np, const void *vp, nvflag_t flags) {
 
             if (flags & NV_APPEND) {
                 if (dot == 0) return;
-                append = strlen(FETCH_VTP(up, const_cp));
+                append = up->scap ? (int)up->slen : (int)strlen(FETCH_VTP(up, const_cp));
                 if (!tofree || size) {
                     offset = stktell(shp->stk);
                     sfputr(shp->stk, FETCH_VTP(up, const_cp), -1);
@@ -1749,11 +1765,22 @@ void nv_putval(Namval_t *np, const void *vp, nvflag_t flags) {
                     cp = (char *)EmptyStr;  // we'd better not try to modify this buf as it's const
                     nv_onattr(np, NV_NOFREE);
                 } else {
+                    cap = ((size_t)dot + append + 8) & ~(size_t)VALUE_ASCII;
+                    ascii = append ? up->scap & VALUE_ASCII : VALUE_ASCII;
                     if (tofree && tofree != Empty && tofree != EmptyStr) {
-                        cp = realloc(tofree, (unsigned)dot + append + 8);
+                        if (!append) {
+                            cp = realloc(tofree, cap);
+                        } else if (cap <= (up->scap & ~VALUE_ASCII)) {
+                            cap = up->scap & ~VALUE_ASCII;
+                            cp = tofree;
+                        } else {
+                            // Grow geometrically so that repeated appends take linear time.
+                            cap += (cap / 2) & ~(size_t)VALUE_ASCII;
+                            cp = realloc(tofree, cap);
+                        }
                         tofree = 0;
                     } else {
-                        cp = malloc((unsigned)dot + 8);
+                        cp = malloc(cap);
                     }
                     cp[dot + append] = 0;
                     nv_offattr(np, NV_NOFREE);
@@ -1772,6 +1799,14 @@ void nv_putval(Namval_t *np, const void *vp, nvflag_t flags) {
             } else {
                 cp[dot + append] = c;
             }
+            if (cap && cap <= UINT32_MAX && !nv_isattr(np, NV_LJUST | NV_RJUST | NV_ZFILL)) {
+                // Record the length so that appending and ${#var} need not scan the string.
+                for (int i = append; ascii && i < dot + append; i++) {
+                    if (!isascii(cp[i])) ascii = 0;
+                }
+                up->slen = dot + append;
+                up->scap = cap | ascii;
+            }
             if (nv_isattr(np, NV_RJUST) && nv_isattr(np, NV_ZFILL)) {
                 rightjust(cp, size, '0');
             } else if (nv_isattr(np, NV_LJUST | NV_RJUST) == NV_RJUST) {
@@ -1933,6 +1968,7 @@ static_fn void pushnam(Namval_t *np, void *data) {
     struct adata *ap = (struct adata *)data;
     ap->sh = sh_ptr(np);
     ap->tp = NULL;
+    if (nv_hasget(np) || nv_isarray(np)) ap->dynamic = true;
     if (nv_isattr(np, NV_IMPORT) && np->nvenv) {
         assert(np->nvenv_is_cp);
         *ap->argnam++ = (char *)np->nvenv;
@@ -1945,6 +1981,109 @@ static_fn void pushnam(Namval_t *np, void *data) {
     }
 }
 
+static_fn void envforget(void) {
+    while (envcache.nchanged) free(envcache.changed[--envcache.nchanged]);
+}
+
+//
+// Copy the environment list <er> into malloc'ed space that is kept in the environment cache.
+// Like the list on the stack, it has room for two more entries in front of it.
+//
+static_fn char **envsave(char **er) {
+    char **ep, **xp, *cp;
+    size_t n = 3, size = 0;
+
+    envforget();
+    for (ep = er; *ep; ep++, n++) size += strlen(*ep) + 1;
+    xp = malloc(n * sizeof(char *) + size);
+    if (!xp) return er;
+    free(envcache.old);
+    envcache.old = envcache.envp ? envcache.envp - 2 : NULL;
+    cp = (char *)(xp + n);
+    for (xp += 2, ep = er; *ep; ep++) {
+        *xp++ = cp;
+        cp = stpcpy(cp, *ep) + 1;
+    }
+    *xp = NULL;
+    envcache.envp = xp - (n - 3);
+    envcache.serial = ast.env_serial;
+    envcache.dynamic = false;
+    return envcache.envp;
+}
+
+//
+// Record an assignment to exported variable <np>. If the cached environment is current, only the
+// entry for <np> has to be made again.
+//
+void sh_envput(Shell_t *shp, Namval_t *np) {
+    char *name = nv_name(np);
+    int i;
+
+    UNUSED(shp);
+    if (!envcache.envp || envcache.serial != ast.env_serial || envcache.dynamic ||
+        strchr(name, '.')) {
+        env_change();
+        return;
+    }
+    for (i = 0; i < envcache.nchanged; i++) {
+        if (!strcmp(envcache.changed[i], name)) break;
+    }
+    if (i == envcache.nchanged) {
+        if (i == ENV_CHANGES || !(envcache.changed[i] = strdup(name))) {
+            env_change();
+            return;
+        }
+        envcache.nchanged++;
+    }
+    envcache.serial = env_change();
+}
+
+//
+// Patch the variables assigned since the cached environment was generated into a copy of it.
+// Returns false if the whole list has to be generated again.
+//
+static_fn bool envpatch(Shell_t *shp) {
+    char **er, **ep, *name, *value;
+    size_t len;
+    int i, n;
+    Namval_t *np;
+
+    for (n = 0; envcache.envp[n]; n++) {
+        ;  // empty loop
+    }
+    er = stkalloc(shp->stk, (n + envcache.nchanged + 3) * sizeof(char *));
+    memcpy(er += 2, envcache.envp, (n + 1) * sizeof(char *));
+    for (i = 0; i < envcache.nchanged; i++) {
+        name = envcache.changed[i];
+        len = strlen(name);
+        for (ep = er; *ep; ep++) {
+            if (!strncmp(*ep, name, len) && (*ep)[len] == '=') break;
+        }
+        np = nv_search(name, shp->var_base, 0);
+        if (!np || !nv_isattr(np, NV_EXPORT)) {
+            value = NULL;
+        } else if (nv_hasget(np) || nv_isarray(np) || (!*ep && nv_isattr(np, ENV_ATTRS))) {
+            // Dynamic values and new entries in the attribute list need the whole list.
+            return false;
+        } else if (nv_isattr(np, NV_IMPORT) && np->nvenv) {
+            value = (char *)np->nvenv;
+        } else {
+            value = nv_getval(np);
+            if (value) value = staknam(shp, np, value);
+        }
+        if (value) {
+            if (!*ep) ep[1] = NULL;
+            *ep = value;
+        } else if (*ep) {
+            do {
+                ep[0] = ep[1];
+            } while (*ep++);
+        }
+    }
+    envsave(er);
+    return true;
+}
+
 //
 // Generate the environment list for the child.
 //
@@ -1953,12 +2092,20 @@ char **sh_envgen(Shell_t *shp) {
     int namec;
     char *cp;
     struct adata data;
+    // Local variables of a function scope can hide exported ones without an environment change.
+    bool global = shp->var_tree == shp->var_base && !dtvnext(shp->var_tree);
 
     data.sh = shp;
     data.tp = NULL;
     data.mapname = 0;
+    data.dynamic = false;
     // L_ARGNOD gets generated automatically as full path name of command.
     nv_offattr(L_ARGNOD, NV_EXPORT);
+    if (global && envcache.envp && envcache.serial == ast.env_serial && !envcache.dynamic &&
+        (!envcache.nchanged || envpatch(shp))) {
+        sh_stats(STAT_ENVHITS);
+        return envcache.envp;
+    }
     data.attsize = 6;
     namec = nv_scan(shp->var_tree, NULL, NULL, NV_EXPORT, NV_EXPORT);
     namec += shp->nenv;
@@ -1968,14 +2115,29 @@ char **sh_envgen(Shell_t *shp) {
     nv_scan(shp->var_tree, pushnam, &data, NV_EXPORT, NV_EXPORT);
     *data.argnam = stkalloc(shp->stk, data.attsize);
     cp = data.attval = stpcpy(*data.argnam, e_envmarker);
-    nv_scan(shp->var_tree, attstore, &data, 0,
-            (NV_RDONLY | NV_UTOL | NV_LTOU | NV_RJUST | NV_LJUST | NV_ZFILL | NV_INTEGER));
+    nv_scan(shp->var_tree, attstore, &data, 0, ENV_ATTRS);
     *data.attval = 0;
     if (cp != data.attval) data.argnam++;
     *data.argnam = 0;
+    if (global) {
+        if (!data.dynamic) return envsave(er);
+        envforget();
+        envcache.serial = ast.env_serial;
+        envcache.dynamic = true;
+    }
     return er;
 }
 
+//
+// Generate the environment for an external command in the parent, so that the child inherits it
+// with the cache instead of generating it after fork().
+//
+void sh_envprefork(Shell_t *shp) {
+    if (shp->var_tree != shp->var_base || dtvnext(shp->var_tree)) return;
+    if (envcache.dynamic && envcache.serial == ast.env_serial) return;
+    sh_envgen(shp);
+}
+
 struct scan {
     void (*scanfn)(Namval_t *, void *);
     nvflag_t scanmask;
@@ -2624,6 +2786,9 @@ void nv_newattr(Namval_t *np, nvflag_t newatts, int size) {
             sh_envput(shp, np);
         }
         if ((nvflags ^ newatts) == NV_EXPORT && size == -1) return;
+    } else if (nv_isflag(nvflags, NV_EXPORT)) {
+        // The attributes are exported with the variable.
+        env_change();
     }
     oldsize = nv_size(np);
     if (size == -1) size = oldsize;
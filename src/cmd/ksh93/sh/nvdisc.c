@@ -400,6 +400,15 @@ static_fn Sfdouble_t lookupn(Namval_t *np, Namfun_t *handle) {
     return d;
 }
 
+//
+// The environment kept by sh_envgen() holds the values of exported variables as they were when it
+// was generated. That no longer holds once a discipline computes the value of an exported variable,
+// so have it generated again.
+//
+static_fn void disc_envchange(Namval_t *np, const Namdisc_t *dp) {
+    if (nv_isattr(np, NV_EXPORT) && dp && (dp->getval || dp->getnum)) ast.env_serial++;
+}
+
 //
 // Set disc on given <event> to <action>.
 // If action==np, the current disc is returned.
@@ -479,6 +488,7 @@ char *nv_setdisc(Namval_t *np, const void *event, Namval_t *action, Namfun_t *fp
         } else if (type == LOOKUPN) {
             dp->getnum = lookupn;
         }
+        disc_envchange(np, dp);
         vp->disc[type] = action;
     } else {
         action = vp->disc[type];
@@ -659,6 +669,7 @@ Namfun_t *nv_disc(Namval_t *np, Namfun_t *fp, Nvdisc_op_t op) {
             fp->next = *lpp;
         }
         *lpp = fp;
+        disc_envchange(np, fp->disc);
     } else {
         if (op.val == DISC_OP_FIRST_val) {
             return np->nvfun;
@@ -308,7 +308,7 @@ Shnode_t *sh_parse(Shell_t *shp, Sfio_t *iop, int flag) {
     int sav_prompt = shp->nextprompt;
 
     if (shp->binscript && (sffileno(iop) == shp->infd || (flag & SH_FUNEVAL))) {
-        return sh_trestore(shp, iop);
+        return sh_trestore(shp, iop, shp->binscript);
     }
     fcsave(&sav_input);
     shp->st.staklist = NULL;
@@ -334,17 +334,17 @@ Shnode_t *sh_parse(Shell_t *shp, Sfio_t *iop, int flag) {
             fcclose();
             fcrestore(&sav_input);
             lexp->arg = sav_arg;
-            if (version > 3) {
+            if (version > SH_TDUMPVERSION) {
                 errormsg(SH_DICT, ERROR_exit(1), e_lexversion);
                 __builtin_unreachable();
             }
-            if (sffileno(iop) == shp->infd || (flag & SH_FUNEVAL)) shp->binscript = 1;
+            if (sffileno(iop) == shp->infd || (flag & SH_FUNEVAL)) shp->binscript = version;
             sfgetc(iop);
-            t = sh_trestore(shp, iop);
+            t = sh_trestore(shp, iop, version);
             if (flag & SH_NL) {
                 Shnode_t *tt;
                 while (1) {
-                    if (!(tt = sh_trestore(shp, iop))) break;
+                    if (!(tt = sh_trestore(shp, iop, version))) break;
                     t = makelist(lexp, TLST, t, tt);
                 }
             }
@@ -609,6 +609,105 @@ static_fn struct regnod *syncase(Lex_t *lexp, int esym) {
     return r;
 }
 
+#define SW_MIN 4  // cases with fewer patterns are not indexed
+
+//
+// Return true if c matches only itself in a case pattern.
+//
+static_fn bool swindex_char(int c) {
+    return (isascii(c) && isalnum(c)) || (c && strchr("_-+.,:/=#", c));
+}
+
+unsigned int sh_swhash(const char *s) {
+    unsigned int h = 0;
+
+    while (*s) h = h * 31 + *(unsigned char *)s++;
+    return h;
+}
+
+//
+// Build the pattern index for the case arms in reg on stack stkp. Return NULL if there are too
+// few patterns or none of them can be looked up or compared without strmatch().
+//
+struct swindex *sh_swindex(Stk_t *stkp, struct regnod *reg) {
+    struct swindex *sp;
+    struct swpat *pp;
+    struct swlit *lp;
+    struct argnod *ap;
+    struct regnod *rp;
+    const char *cp;
+    const char *ep;
+    unsigned int h;
+    int npat = 0;
+    int nlit = 0;
+    int arm;
+    int first;
+    bool skip = true;
+    bool raw;
+
+    for (rp = reg; rp; rp = rp->regnxt) {
+        for (ap = rp->regptr; ap; ap = ap->argnxt.ap) {
+            npat++;
+            if (ap->argflag & ARG_RAW) nlit++;
+        }
+    }
+    if (npat < SW_MIN) return NULL;
+    sp = stkalloc(stkp, sizeof(struct swindex) + npat * sizeof(struct swpat));
+    for (h = 4; h < 2 * nlit; h <<= 1) {
+        ;  // empty loop
+    }
+    sp->mask = h - 1;
+    sp->table = stkalloc(stkp, h * sizeof(struct swlit *));
+    memset(sp->table, 0, h * sizeof(struct swlit *));
+    pp = sp->pat;
+    npat = 0;
+    for (rp = reg, arm = 0; rp; rp = rp->regnxt, arm++) {
+        first = pp - sp->pat;
+        raw = true;
+        for (ap = rp->regptr; ap; ap = ap->argnxt.ap, pp++) {
+            memset(pp, 0, sizeof(*pp));
+            if (!(ap->argflag & ARG_RAW)) raw = false;
+            if (ap->argflag & ARG_MAC) continue;
+            if (ap->argflag & ARG_RAW) {
+                pp->kind = SW_LITERAL;
+                npat++;
+                h = sh_swhash(ap->argval);
+                for (lp = sp->table[h & sp->mask]; lp; lp = lp->next) {
+                    if (lp->hval == h && !strcmp(lp->val, ap->argval)) break;
+                }
+                if (lp) continue;
+                lp = stkalloc(stkp, sizeof(struct swlit));
+                lp->hval = h;
+                lp->arm = arm;
+                lp->pat = first;
+                lp->skip = skip;
+                lp->reg = rp;
+                lp->val = ap->argval;
+                lp->next = sp->table[h & sp->mask];
+                sp->table[h & sp->mask] = lp;
+                continue;
+            }
+            for (cp = ap->argval; swindex_char(*cp); cp++) {
+                ;  // empty loop
+            }
+            pp->plen = cp - ap->argval;
+            if (*cp == '*') {
+                pp->star = 1;
+                cp++;
+            }
+            for (ep = cp; swindex_char(*ep); ep++) {
+                ;  // empty loop
+            }
+            if (*ep || ep - ap->argval > USHRT_MAX) continue;
+            pp->slen = ep - cp;
+            pp->kind = SW_SIMPLE;
+            npat++;
+        }
+        skip = skip && raw;
+    }
+    return npat ? sp : NULL;
+}
+
 //
 // This routine creates the parse tree for the arithmetic for what? When called, shlex.arg contains
 // the string inside ((...)). When the first argument is missing, a while node is returned. Otherise
@@ -1110,6 +1209,7 @@ static_fn Shnode_t *item(Lex_t *lexp, int flag) {
                 lexp->lastline = saveline;
                 sh_syntax(lexp);
             }
+            t->sw.swidx = sh_swindex(stkstd, t->sw.swlst);
             break;
         }
         case IFSYM: {  // if statement
@@ -23,6 +23,7 @@
 //
 #include "config_ast.h"  // IWYU pragma: keep
 
+#include <dirent.h>
 #include <dlfcn.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -32,7 +33,10 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "argnod.h"
@@ -51,6 +55,7 @@
 #include "path.h"
 #include "sfio.h"
 #include "shcmd.h"
+#include "shnodes.h"
 #include "stk.h"
 #include "test.h"
 #include "variables.h"
@@ -62,11 +67,14 @@
 #define LIBCMD "cmd"
 
 static_fn int can_execute(Shell_t *, char *, bool);
+static_fn bool path_dirmiss(Shell_t *, Pathcomp_t *, const char *);
+static_fn void dircache_free(struct dircache *);
 static_fn void funload(Shell_t *, int, const char *);
 static_fn void exscript(Shell_t *, char *, char *[], char *const *);
 static_fn bool path_chkpaths(Shell_t *, Pathcomp_t *, Pathcomp_t *, Pathcomp_t *, int);
 static_fn void path_checkdup(Shell_t *shp, Pathcomp_t *);
 static_fn Pathcomp_t *defpath_init(Shell_t *shp);
+static_fn bool path_dirmiss(Shell_t *, Pathcomp_t *, const char *);
 
 static const char *std_path = NULL;
 
@@ -310,6 +318,7 @@ void path_delete(Pathcomp_t *first) {
         if (--pp->refcount <= 0) {
             if (pp->lib) free(pp->lib);
             if (pp->bbuf) free(pp->bbuf);
+            if (pp->dircache) dircache_free(pp->dircache);
             free(pp);
             if (old) old->next = ppnext;
         } else {
@@ -500,6 +509,7 @@ static_fn int path_opentype(Shell_t *shp, const char *name, Pathcomp_t *pp, int
         pp = path_nextcomp(shp, oldpp = pp, name, 0);
         while (oldpp && (oldpp->flags & PATH_SKIP)) oldpp = oldpp->next;
         if (fun && (!oldpp || !(oldpp->flags & PATH_FPATH))) continue;
+        if (fun && path_dirmiss(shp, oldpp, name)) continue;
         fd = sh_open(path_relative(shp, stkptr(shp->stk, PATH_OFFSET)), O_RDONLY | O_CLOEXEC, 0);
         if (fd >= 0 && (fstat(fd, &statb) < 0 || S_ISDIR(statb.st_mode))) {
             errno = EISDIR;
@@ -555,14 +565,159 @@ char *path_fullname(Shell_t *shp, const char *name) {
     return path;
 }
 
+//
+// When FPATH_CACHE names a directory, the trees parsed from each function file that is autoloaded
+// are saved there in the sh_tdump() format so that later shells can read them instead of parsing
+// the file. A cache file begins with a line holding the shell release, the options that change the
+// parse, and the path, size and modification time of the function file. It is only used when all
+// of these match. A file modified in the current second is not cached since a change later in that
+// second would go unnoticed.
+//
+#define CNTL(x) ((x)&037)
+
+struct fpcache {
+    Sfdisc_t disc;
+    void *addr;
+    size_t size;
+};
+
+static const char fpcache_header[6] = {CNTL('k'), CNTL('s'), CNTL('h'), 0, SH_TDUMPVERSION, 0};
+
+//
+// Return the first line of the cache file for function file <path> open on <fd>, or NULL when
+// the file cannot be cached. The name of the cache file is returned in <file>.
+//
+static_fn char *fpcache_key(Shell_t *shp, int fd, const char *path, char **file) {
+    Namval_t *np;
+    const char *dir = NULL, *name;
+    struct stat statb;
+    int opts = 0;
+    char *cp;
+
+    if (sh_isoption(shp, SH_VERBOSE) || sh_isoption(shp, SH_NOEXEC) ||
+        sh_isoption(shp, SH_DICTIONARY)) {
+        return NULL;
+    }
+    np = nv_open("FPATH_CACHE", shp->var_tree, NV_NOADD);
+    if (np) {
+        dir = nv_getval(np);
+        nv_close(np);
+    }
+    if (!dir || *dir != '/') return NULL;
+    if (fstat(fd, &statb) < 0 || !S_ISREG(statb.st_mode) || statb.st_mtime >= time(NULL)) {
+        return NULL;
+    }
+    if (sh_isoption(shp, SH_POSIX)) opts |= 1;
+    if (sh_isoption(shp, SH_BASH)) opts |= 2;
+    if (sh_isoption(shp, SH_BRACEEXPAND)) opts |= 4;
+    if (sh_isoption(shp, SH_KEYWORD)) opts |= 8;
+    name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    sfprintf(shp->strbuf, "%s/%s.%08x", dir, name, dtstrhash(0, (char *)path, 0));
+    if (!(cp = sfstruse(shp->strbuf))) return NULL;
+    *file = strdup(cp);
+    sfprintf(shp->strbuf, "%s %d %lld %lld %s\n", fmtident(e_version), opts,
+             (Sflong_t)statb.st_size, (Sflong_t)statb.st_mtime, path);
+    if (!(cp = sfstruse(shp->strbuf))) {
+        free(*file);
+        *file = NULL;
+        return NULL;
+    }
+    return strdup(cp);
+}
+
+static_fn int fpcache_except(Sfio_t *iop, int type, void *data, Sfdisc_t *handle) {
+    struct fpcache *cp = (struct fpcache *)handle;
+    UNUSED(iop);
+    UNUSED(data);
+
+    if (type == SF_DPOP || type == SF_FINAL) {
+        munmap(cp->addr, cp->size);
+        free(cp);
+    }
+    return 0;
+}
+
+//
+// Map cache file <file> and return a stream of the trees that follow <key>, or NULL if the file
+// does not exist or is out of date.
+//
+static_fn Sfio_t *fpcache_open(const char *file, const char *key) {
+    struct fpcache *cp;
+    struct stat statb;
+    Sfio_t *iop;
+    size_t n = strlen(key);
+    void *addr;
+    int fd;
+
+    fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    if (fstat(fd, &statb) < 0 || statb.st_size <= (off_t)(n + sizeof(fpcache_header))) {
+        close(fd);
+        return NULL;
+    }
+    addr = mmap(NULL, statb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return NULL;
+    if (memcmp(addr, key, n) || memcmp((char *)addr + n, fpcache_header, sizeof(fpcache_header)) ||
+        !(cp = calloc(1, sizeof(struct fpcache)))) {
+        munmap(addr, statb.st_size);
+        return NULL;
+    }
+    cp->addr = addr;
+    cp->size = statb.st_size;
+    cp->disc.exceptf = fpcache_except;
+    iop = sfnew(NULL, (char *)addr + n, statb.st_size - n, -1, SF_STRING | SF_READ);
+    if (!iop) {
+        fpcache_except(NULL, SF_FINAL, NULL, &cp->disc);
+        return NULL;
+    }
+    sfdisc(iop, &cp->disc);
+    return iop;
+}
+
+//
+// Create a temporary file next to cache file <file> for the trees that are about to be parsed.
+//
+static_fn Sfio_t *fpcache_create(Shell_t *shp, const char *file, const char *key, char **tmp) {
+    Sfio_t *out;
+    char *cp;
+
+    sfprintf(shp->strbuf, "%s.%d", file, (int)getpid());
+    if (!(cp = sfstruse(shp->strbuf))) return NULL;
+    *tmp = strdup(cp);
+    out = sfopen(NULL, *tmp, "wx");
+    if (!out) {
+        free(*tmp);
+        *tmp = NULL;
+        return NULL;
+    }
+    sfputr(out, key, -1);
+    sfwrite(out, fpcache_header, sizeof(fpcache_header));
+    return out;
+}
+
+//
+// Replace the cache file with the temporary file if the trees were all written.
+//
+static_fn void fpcache_close(Sfio_t *out, const char *tmp, const char *file, bool ok) {
+    if (sferror(out)) ok = false;
+    if (sfclose(out) < 0) ok = false;
+    if (!ok || rename(tmp, file) < 0) remove(tmp);
+}
+
 //
 // Load functions from file <fno>.
 //
 static_fn void funload(Shell_t *shp, int fno, const char *name) {
     char *pname, *oldname = shp->st.filename, buff[IOBSIZE + 1];
+    char *key = NULL, *file = NULL, *tmp = NULL;
     Namval_t *np;
     struct Ufunction *rp, *rpfirst;
     int savestates = sh_getstate(shp), oldload = shp->funload;
+    Sfio_t *iop = NULL, *dump = NULL;
+    checkpt_t checkpoint;
+    int jmpval = 0;
 
     pname = path_fullname(shp, stkptr(shp->stk, PATH_OFFSET));
     if (shp->fpathdict && (rp = dtmatch(shp->fpathdict, pname))) {
@@ -590,7 +745,33 @@ static_fn void funload(Shell_t *shp, int fno, const char *name) {
     shp->st.filename = pname;
     shp->funload = 1;
     error_info.line = 0;
-    sh_eval(shp, sfnew(NULL, buff, IOBSIZE, fno, SF_READ), SH_FUNEVAL);
+    if ((key = fpcache_key(shp, fno, pname, &file))) {
+        if ((iop = fpcache_open(file, key))) {
+            sh_stats(STAT_FPATHHITS);
+        } else {
+            dump = fpcache_create(shp, file, key, &tmp);
+        }
+        free(key);
+    }
+    if (!iop) iop = sfnew(NULL, buff, IOBSIZE, fno, SF_READ);
+    if (dump) {
+        // The temporary file must be removed if the function file fails to load.
+        sh_pushcontext(shp, &checkpoint, 1);
+        jmpval = sigsetjmp(checkpoint.buff, 0);
+        if (jmpval == 0) {
+            shp->treedump = dump;
+            sh_eval(shp, iop, SH_FUNEVAL);
+        }
+        sh_popcontext(shp, &checkpoint);
+        fpcache_close(dump, tmp, file, jmpval == 0 && shp->treedump == dump);
+        shp->treedump = NULL;
+        free(tmp);
+        free(file);
+        if (jmpval) siglongjmp(shp->jmplist->buff, jmpval);
+    } else {
+        free(file);
+        sh_eval(shp, iop, SH_FUNEVAL);
+    }
     sh_close(fno);
     shp->readscript = NULL;
     if (shp->namespace) {
@@ -815,8 +996,13 @@ Pathcomp_t *path_absolute(Shell_t *shp, const char *name, Pathcomp_t *pp) {
             }
         }
         shp->bltin_dir = NULL;
-        sh_stats(STAT_PATHS);
-        fd = can_execute(shp, stkptr(shp->stk, PATH_OFFSET), isfun);
+        if (path_dirmiss(shp, oldpp, name)) {
+            fd = -1;
+            errno = ENOENT;
+        } else {
+            sh_stats(STAT_PATHS);
+            fd = can_execute(shp, stkptr(shp->stk, PATH_OFFSET), isfun);
+        }
         if (isfun && fd >= 0 && (cp = strrchr(name, '.'))) {
             *cp = 0;
             if (nv_open(name, sh_subfuntree(shp, 1), NV_NOARRAY | NV_IDENT | NV_NOSCOPE)) {
@@ -914,6 +1100,139 @@ err:
     return -1;
 }
 
+//
+// Snapshot of the names in a PATH directory. It is valid while the device, inode and modification
+// time of the directory are unchanged, and the directory was not modified in the second the
+// snapshot was taken.
+//
+struct dircache {
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    time_t when;      // time the snapshot was taken
+    int searches;     // searches since the snapshot was dropped or the directory could not be read
+    bool unreadable;  // the directory could not be read the last time it was tried
+    size_t nnames;
+    char **names;     // names sorted ignoring case, NULL if there is no snapshot
+};
+
+// Number of searches in a directory before its names are read.
+#define DIRCACHE_SEARCHES 3
+// Number of searches in a directory that could not be read before it is tried again.
+#define DIRCACHE_RETRY 256
+
+static_fn int dircache_cmp(const void *a, const void *b) {
+    return strcasecmp(*(char *const *)a, *(char *const *)b);
+}
+
+static_fn void dircache_free(struct dircache *dp) {
+    free(dp->names);
+    free(dp);
+}
+
+//
+// Read the names in directory <dir> into <dp>. The names array and the names share one allocation.
+//
+static_fn bool dircache_read(struct dircache *dp, const char *dir) {
+    DIR *dirp;
+    struct dirent *ent;
+    char *buf = NULL, *cp, **names = NULL;
+    size_t *offs = NULL, n = 0, nmax = 0, size = 0, bmax = 0, len, i;
+    void *mem;
+
+    dirp = opendir(dir);
+    if (!dirp) return false;
+    while ((ent = readdir(dirp))) {
+        len = strlen(ent->d_name) + 1;
+        if (n >= nmax) {
+            nmax = nmax ? 2 * nmax : 256;
+            mem = realloc(offs, nmax * sizeof(size_t));
+            if (!mem) goto done;
+            offs = mem;
+        }
+        if (size + len > bmax) {
+            bmax = 2 * (size + len) + 4096;
+            mem = realloc(buf, bmax);
+            if (!mem) goto done;
+            buf = mem;
+        }
+        offs[n++] = size;
+        memcpy(buf + size, ent->d_name, len);
+        size += len;
+    }
+    names = malloc(n * sizeof(char *) + size);
+    if (names) {
+        cp = (char *)(names + n);
+        if (size) memcpy(cp, buf, size);
+        for (i = 0; i < n; i++) names[i] = cp + offs[i];
+        qsort(names, n, sizeof(char *), dircache_cmp);
+        dp->names = names;
+        dp->nnames = n;
+    }
+
+done:
+    closedir(dirp);
+    free(buf);
+    free(offs);
+    return names != NULL;
+}
+
+//
+// Return true if the directory of path component <pp> is known not to contain <name>. This is
+// only done with the trackall option. Once a directory has been searched a few times its names
+// are read, and after that a search needs a stat() of the directory instead of a failed stat() of
+// the file. Names that are found are still checked by can_execute(). The names are compared
+// ignoring case so that case insensitive file systems are never answered wrongly.
+//
+static_fn bool path_dirmiss(Shell_t *shp, Pathcomp_t *pp, const char *name) {
+    struct dircache *dp = pp->dircache;
+    struct stat statb;
+
+#if __CYGWIN__
+    // can_execute() also looks for .exe and .bat suffixes.
+    return false;
+#endif
+    if (!sh_isoption(shp, SH_TRACKALL) || *pp->name != '/') return false;
+    if (!dp) {
+        dp = pp->dircache = calloc(1, sizeof(struct dircache));
+        if (!dp) return false;
+    }
+    if (dp->unreadable) {
+        // Such as a directory that can be searched but not read, or one that does not exist.
+        if (++dp->searches < DIRCACHE_RETRY) return false;
+        dp->unreadable = false;
+    } else if (!dp->names && ++dp->searches < DIRCACHE_SEARCHES) {
+        return false;
+    }
+    if (sh_stat(pp->name, &statb) < 0 || !S_ISDIR(statb.st_mode)) goto unreadable;
+    if (dp->names && (dp->dev != statb.st_dev || dp->ino != statb.st_ino ||
+                      dp->mtime != statb.st_mtime || dp->mtime >= dp->when)) {
+        // A directory that keeps changing must be searched a few more times before it is reread.
+        free(dp->names);
+        dp->names = NULL;
+        dp->searches = 0;
+        return false;
+    }
+    if (!dp->names) {
+        dp->when = time(NULL);
+        if (!dircache_read(dp, pp->name)) goto unreadable;
+        dp->dev = statb.st_dev;
+        dp->ino = statb.st_ino;
+        dp->mtime = statb.st_mtime;
+    }
+    if (bsearch(&name, dp->names, dp->nnames, sizeof(char *), dircache_cmp)) return false;
+    sh_stats(STAT_PATHHITS);
+    return true;
+
+unreadable:
+    // Leave the directory to can_execute() instead of a stat() and opendir() on every search.
+    free(dp->names);
+    dp->names = NULL;
+    dp->unreadable = true;
+    dp->searches = 0;
+    return false;
+}
+
 //
 // Return path relative to present working directory.
 //
@@ -80,6 +80,7 @@ typedef struct vars {  // vars stacked per invocation
     int stakmaxsize;      // maximum stack size needed
     unsigned char paren;  // parenthesis level
     char infun;           // incremented by comma inside function
+    bool hasfloat;        // floating point literal or function call compiled
     int emode;
     Sfdouble_t (*convert)(const char **, struct lval *, int, Sfdouble_t);
 } vars_t;
@@ -161,18 +162,113 @@ static_fn void array_args(Shell_t *shp, char *tp, int n) {
     }
 }
 
-Sfdouble_t arith_exec(Arith_t *ep) {
-    Sfdouble_t num = 0, *dp, *sp;
+//
+// Return true if `d` is exactly representable as a Sflong_t. Negative zero is excluded since the
+// integer executor cannot represent it and it is visible when assigned to an untyped variable.
+//
+static inline bool arith_isint(Sfdouble_t d) {
+    if (d == 0) return !signbit(d);
+    return d >= LDBL_LLONG_MIN && d < -LDBL_LLONG_MIN && (Sflong_t)d == d;
+}
+
+//
+// Fetch the value of the variable referenced by the A_PUSHV or A_ASSIGNOP1 operand at `*cpp`.
+//
+static_fn Sfdouble_t arith_pushv(Arith_t *ep, unsigned char **cpp, struct lval *node,
+                                 char **lastval, int *lastsub, const char **ptr, Sfdouble_t num) {
+    unsigned char *cp = roundptr(ep, *cpp, Sfdouble_t *);
+    Sfdouble_t *dp = *((Sfdouble_t **)cp);
+
+    cp += sizeof(Sfdouble_t *);
+    node->flag = *(short *)cp;
+    cp += sizeof(short);
+    *cpp = cp;
+    *lastval = node->value = (char *)dp;
+    if (node->flag) *lastval = NULL;
+    node->isfloat = 0;
+    node->isint = 0;
+    node->level = level;
+    node->nosub = 0;
+    node->nextop = *cp;
+    if (node->nextop == A_JMP) {
+        node->nextop = ((unsigned char *)ep)[*((short *)roundptr(ep, cp + 1, short))];
+    }
+    num = (*ep->fun)(ptr, node, VALUE, num);
+    if (*lastval) *lastval = node->ovalue;
+    if (node->emode & ARITH_ASSIGNOP) {
+        *lastsub = node->nosub;
+        node->nosub = 0;
+        node->emode &= ~ARITH_ASSIGNOP;
+    }
+    if (node->value != (char *)dp) arith_error(node->value, *ptr, ep->emode);
+    return num;
+}
+
+//
+// Assign `num` to the variable referenced by the A_STORE or A_ASSIGNOP operand at `*cpp`.
+//
+static_fn Sfdouble_t arith_store(Arith_t *ep, unsigned char **cpp, struct lval *node,
+                                 char **lastval, const char **ptr, Sfdouble_t num) {
+    unsigned char *cp = roundptr(ep, *cpp, Sfdouble_t *);
+    Sfdouble_t *dp = *((Sfdouble_t **)cp);
+    int c;
+
+    cp += sizeof(Sfdouble_t *);
+    c = *(short *)cp;
+    if (c < 0) c = 0;
+    cp += sizeof(short);
+    *cpp = cp;
+    node->value = (char *)dp;
+    node->flag = c;
+    if (*lastval) node->eflag = 1;
+    node->ptr = NULL;
+    num = (*ep->fun)(ptr, node, ASSIGN, num);
+    if (*lastval && node->ptr) {
+        Sfdouble_t r;
+        node->flag = 0;
+        node->value = *lastval;
+        r = (*ep->fun)(ptr, node, VALUE, num);
+        if (r != num) {
+            node->flag = c;
+            node->value = (char *)dp;
+            node->isint = 0;
+            num = (*ep->fun)(ptr, node, ASSIGN, r);
+        }
+
+    } else if (*lastval && num == 0 && sh_isoption(ep->shp, SH_NOUNSET) &&
+               nv_isnull((Namval_t *)*lastval)) {
+        arith_error((char *)ERROR_dictionary(e_notset), nv_name((Namval_t *)*lastval), 3);
+    }
+    *lastval = NULL;
+    return num;
+}
+
+//
+// Execute a compiled expression. If `isint` is not NULL it is set to true when the result was
+// computed entirely in 64 bit integer arithmetic, in which case it is an exact Sflong_t value.
+//
+// Expressions that arith_compile() determined have no floating point literals or function calls
+// are first run by an executor that keeps its stack as Sflong_t. As soon as that executor sees a
+// value or a result that cannot be represented exactly as a Sflong_t (a floating point or
+// unsigned variable, or an operation that would overflow) it converts its stack and continues with
+// the long double executor from the same point, so the result is the same either way.
+//
+Sfdouble_t arith_execute(Arith_t *ep, bool *isint) {
+    Sfdouble_t num = 0, *sp;
     unsigned char *cp = ep->code;
     int c, type = 0;
     char *tp;
     Sfdouble_t d, small_stack[SMALL_STACK + 1], arg[9];
+    Sflong_t inum = 0, *isp, *ibase, small_istack[2 * (SMALL_STACK + 1)];
+    char *itp, *itbase;
+    int resume, n;
     const char *ptr = "";
     char *lastval = NULL;
     int lastsub = 0;
     struct lval node;
     Shell_t *shp = ep->shp;
 
+    if (isint) *isint = false;
     memset(&node, 0, sizeof(node));
     node.shp = shp;
     node.emode = ep->emode;
@@ -182,6 +278,261 @@ Sfdouble_t arith_exec(Arith_t *ep) {
         arith_error(e_recursive, ep->expr, ep->emode);
         return 0;
     }
+    if (ep->intonly) {
+        if (ep->staksize < SMALL_STACK) {
+            ibase = small_istack;
+        } else {
+            ibase = stkalloc(shp->stk, ep->staksize * (sizeof(Sfdouble_t) + 1));
+        }
+        itbase = (char *)(ibase + ep->staksize);
+        isp = ibase - 1;
+        itp = itbase - 1;
+        while ((c = *cp++)) {
+            switch (c & T_OP) {
+                case A_JMP:
+                case A_JMPZ:
+                case A_JMPNZ: {
+                    c &= T_OP;
+                    cp = roundptr(ep, cp, short);
+                    if ((c == A_JMPZ && inum) || (c == A_JMPNZ && !inum)) {
+                        cp += sizeof(short);
+                    } else {
+                        cp = (unsigned char *)ep + *((short *)cp);
+                    }
+                    continue;
+                }
+                case A_NOTNOT: {
+                    inum = (inum != 0);
+                    break;
+                }
+                case A_PLUSPLUS: {
+                    if (inum == LLONG_MAX) goto deopt_op;
+                    node.nosub = -1;
+                    node.isint = 1;
+                    node.ivalue = inum + 1;
+                    (*ep->fun)(&ptr, &node, ASSIGN, (Sfdouble_t)node.ivalue);
+                    break;
+                }
+                case A_MINUSMINUS: {
+                    if (inum == LLONG_MIN) goto deopt_op;
+                    node.nosub = -1;
+                    node.isint = 1;
+                    node.ivalue = inum - 1;
+                    (*ep->fun)(&ptr, &node, ASSIGN, (Sfdouble_t)node.ivalue);
+                    break;
+                }
+                case A_INCR: {
+                    if (inum == LLONG_MAX) goto deopt_op;
+                    node.nosub = -1;
+                    node.isint = 1;
+                    node.ivalue = inum + 1;
+                    num = (*ep->fun)(&ptr, &node, ASSIGN, (Sfdouble_t)node.ivalue);
+                    if (!node.isint && !arith_isint(num)) goto deopt_done;
+                    inum = node.isint ? node.ivalue : (Sflong_t)num;
+                    break;
+                }
+                case A_DECR: {
+                    if (inum == LLONG_MIN) goto deopt_op;
+                    node.nosub = -1;
+                    node.isint = 1;
+                    node.ivalue = inum - 1;
+                    num = (*ep->fun)(&ptr, &node, ASSIGN, (Sfdouble_t)node.ivalue);
+                    if (!node.isint && !arith_isint(num)) goto deopt_done;
+                    inum = node.isint ? node.ivalue : (Sflong_t)num;
+                    break;
+                }
+                case A_SWAP: {
+                    inum = isp[-1];
+                    isp[-1] = *isp;
+                    break;
+                }
+                case A_POP: {
+                    isp--;
+                    continue;
+                }
+                case A_ASSIGNOP1: {
+                    node.emode |= ARITH_ASSIGNOP;
+                }
+                // FALLTHRU
+                case A_PUSHV: {
+                    num = arith_pushv(ep, &cp, &node, &lastval, &lastsub, &ptr, (Sfdouble_t)inum);
+                    if (node.isfloat || (!node.isint && !arith_isint(num))) goto deopt_pushv;
+                    inum = node.isint ? node.ivalue : (Sflong_t)num;
+                    *++isp = inum;
+                    *++itp = 0;
+                    c = 0;
+                    break;
+                }
+                case A_ENUM: {
+                    node.eflag = 1;
+                    continue;
+                }
+                case A_ASSIGNOP: {
+                    node.nosub = lastsub;
+                }
+                // FALLTHRU
+                case A_STORE: {
+                    node.isint = 1;
+                    node.ivalue = inum;
+                    num = arith_store(ep, &cp, &node, &lastval, &ptr, (Sfdouble_t)inum);
+                    c = 0;
+                    if (!node.isint && !arith_isint(num)) goto deopt_done;
+                    inum = node.isint ? node.ivalue : (Sflong_t)num;
+                    break;
+                }
+                case A_PUSHL: {
+                    cp = roundptr(ep, cp, Sflong_t);
+                    inum = *((Sflong_t *)cp);
+                    cp += sizeof(Sflong_t);
+                    *++isp = inum;
+                    *++itp = 0;
+                    break;
+                }
+                case A_NOT: {
+                    inum = !inum;
+                    break;
+                }
+                case A_UMINUS: {
+                    // Negating zero yields -0 which is visible to the user.
+                    if (inum == 0 || inum == LLONG_MIN) goto deopt_op;
+                    inum = -inum;
+                    break;
+                }
+                case A_TILDE: {
+                    inum = ~inum;
+                    break;
+                }
+                case A_PLUS: {
+                    Sflong_t r;
+                    if (__builtin_add_overflow(isp[-1], inum, &r)) goto deopt_op;
+                    inum = r;
+                    break;
+                }
+                case A_MINUS: {
+                    Sflong_t r;
+                    if (__builtin_sub_overflow(isp[-1], inum, &r)) goto deopt_op;
+                    inum = r;
+                    break;
+                }
+                case A_TIMES: {
+                    Sflong_t r;
+                    if (__builtin_mul_overflow(isp[-1], inum, &r)) goto deopt_op;
+                    if (r == 0 && (isp[-1] < 0 || inum < 0)) goto deopt_op;  // -0
+                    inum = r;
+                    break;
+                }
+                case A_MOD: {
+                    if (!inum) arith_error(e_divzero, ep->expr, ep->emode);
+                    if (inum == -1 && isp[-1] == LLONG_MIN) goto deopt_op;
+                    inum = isp[-1] % inum;
+                    break;
+                }
+                case A_DIV: {
+                    Sflong_t r;
+                    if (!inum) arith_error(e_divzero, ep->expr, ep->emode);
+                    if ((inum == -1 && isp[-1] == LLONG_MIN) || (inum < 0 && isp[-1] == 0)) {
+                        goto deopt_op;
+                    }
+                    // The long double executor rounds the quotient toward negative infinity.
+                    r = isp[-1] / inum;
+                    if (isp[-1] % inum && (isp[-1] < 0) != (inum < 0)) r--;
+                    inum = r;
+                    break;
+                }
+                case A_LSHIFT: {
+                    if ((long)inum >= CHAR_BIT * sizeof(Sfulong_t)) {
+                        inum = 0;
+                    } else {
+                        inum = isp[-1] << (long)inum;
+                    }
+                    break;
+                }
+                case A_RSHIFT: {
+                    if ((long)inum >= CHAR_BIT * sizeof(Sfulong_t)) {
+                        inum = 0;
+                    } else {
+                        inum = isp[-1] >> (long)inum;
+                    }
+                    break;
+                }
+                case A_XOR: {
+                    inum = isp[-1] ^ inum;
+                    break;
+                }
+                case A_OR: {
+                    inum = isp[-1] | inum;
+                    break;
+                }
+                case A_AND: {
+                    inum = isp[-1] & inum;
+                    break;
+                }
+                case A_EQ: {
+                    inum = (isp[-1] == inum);
+                    break;
+                }
+                case A_NEQ: {
+                    inum = (isp[-1] != inum);
+                    break;
+                }
+                case A_LE: {
+                    inum = (isp[-1] <= inum);
+                    break;
+                }
+                case A_GE: {
+                    inum = (isp[-1] >= inum);
+                    break;
+                }
+                case A_GT: {
+                    inum = (isp[-1] > inum);
+                    break;
+                }
+                case A_LT: {
+                    inum = (isp[-1] < inum);
+                    break;
+                }
+                // Floating point literals, function calls and exponentiation are left to the long
+                // double executor.
+                default: { goto deopt_op; }
+            }
+            if (c) lastval = NULL;
+            if (c & T_BINARY) {
+                node.ptr = NULL;
+                isp--, itp--;
+            }
+            *isp = inum;
+            *itp = 0;
+        }
+        if (level > 0) level--;
+        if (isint) *isint = true;
+        return (Sfdouble_t)inum;
+
+    deopt_op:  // re-execute the current operator
+        cp--;
+        num = (Sfdouble_t)inum;
+        resume = 0;
+        goto deopt;
+    deopt_pushv:  // finish pushing the value just fetched
+        resume = 1;
+        goto deopt;
+    deopt_done:  // finish the current operator with the value just assigned
+        resume = 2;
+    deopt:
+        if (ep->staksize < SMALL_STACK) {
+            sp = small_stack;
+        } else {
+            sp = stkalloc(shp->stk, ep->staksize * (sizeof(Sfdouble_t) + 1));
+        }
+        tp = (char *)(sp + ep->staksize);
+        for (n = 0; ibase + n <= isp; n++) sp[n] = (Sfdouble_t)ibase[n];
+        for (n = 0; itbase + n <= itp; n++) tp[n] = 0;
+        sp += (isp - ibase);
+        tp += (itp - itbase);
+        type = 0;
+        if (resume == 1) goto pushv_done;
+        if (resume == 2) goto op_done;
+        goto execute;
+    }
     if (ep->staksize < SMALL_STACK) {
         sp = small_stack;
     } else {
@@ -189,6 +540,7 @@ Sfdouble_t arith_exec(Arith_t *ep) {
     }
     tp = (char *)(sp + ep->staksize);
     tp--, sp--;
+execute:
     while ((c = *cp++)) {
         if (c & T_NOFLOAT) {
             if (type || ((c & T_BINARY) && (c & T_OP) != A_MOD && tp[-1] == 1)) {
@@ -215,23 +567,27 @@ Sfdouble_t arith_exec(Arith_t *ep) {
             }
             case A_PLUSPLUS: {
                 node.nosub = -1;
+                node.isint = 0;
                 (*ep->fun)(&ptr, &node, ASSIGN, num + 1);
                 break;
             }
             case A_MINUSMINUS: {
                 node.nosub = -1;
+                node.isint = 0;
                 (*ep->fun)(&ptr, &node, ASSIGN, num - 1);
                 break;
             }
             case A_INCR: {
                 num = num + 1;
                 node.nosub = -1;
+                node.isint = 0;
                 num = (*ep->fun)(&ptr, &node, ASSIGN, num);
                 break;
             }
             case A_DECR: {
                 num = num - 1;
                 node.nosub = -1;
+                node.isint = 0;
                 num = (*ep->fun)(&ptr, &node, ASSIGN, num);
                 break;
             }
@@ -252,29 +608,8 @@ Sfdouble_t arith_exec(Arith_t *ep) {
             // TODO: Determine if this should be FALLTHRU.
             // FALLTHRU
             case A_PUSHV: {
-                cp = roundptr(ep, cp, Sfdouble_t *);
-                dp = *((Sfdouble_t **)cp);
-                cp += sizeof(Sfdouble_t *);
-                c = *(short *)cp;
-                cp += sizeof(short);
-                lastval = node.value = (char *)dp;
-                node.flag = c;
-                if (node.flag) lastval = NULL;
-                node.isfloat = 0;
-                node.level = level;
-                node.nosub = 0;
-                node.nextop = *cp;
-                if (node.nextop == A_JMP) {
-                    node.nextop = ((unsigned char *)ep)[*((short *)roundptr(ep, cp + 1, short))];
-                }
-                num = (*ep->fun)(&ptr, &node, VALUE, num);
-                if (lastval) lastval = node.ovalue;
-                if (node.emode & ARITH_ASSIGNOP) {
-                    lastsub = node.nosub;
-                    node.nosub = 0;
-                    node.emode &= ~ARITH_ASSIGNOP;
-                }
-                if (node.value != (char *)dp) arith_error(node.value, ptr, ep->emode);
+                num = arith_pushv(ep, &cp, &node, &lastval, &lastsub, &ptr, num);
+            pushv_done:
                 *++sp = num;
                 type = node.isfloat;
                 if ((d = num) > LDBL_LLONG_MAX && num <= LDBL_ULLONG_MAX) {
@@ -296,37 +631,19 @@ Sfdouble_t arith_exec(Arith_t *ep) {
             // TODO: Determine if this should be FALLTHRU.
             // FALLTHRU
             case A_STORE: {
-                cp = roundptr(ep, cp, Sfdouble_t *);
-                dp = *((Sfdouble_t **)cp);
-                cp += sizeof(Sfdouble_t *);
-                c = *(short *)cp;
-                if (c < 0) c = 0;
-                cp += sizeof(short);
-                node.value = (char *)dp;
-                node.flag = c;
-                if (lastval) node.eflag = 1;
-                node.ptr = NULL;
-                num = (*ep->fun)(&ptr, &node, ASSIGN, num);
-                if (lastval && node.ptr) {
-                    Sfdouble_t r;
-                    node.flag = 0;
-                    node.value = lastval;
-                    r = (*ep->fun)(&ptr, &node, VALUE, num);
-                    if (r != num) {
-                        node.flag = c;
-                        node.value = (char *)dp;
-                        num = (*ep->fun)(&ptr, &node, ASSIGN, r);
-                    }
-
-                } else if (lastval && num == 0 && sh_isoption(shp, SH_NOUNSET) &&
-                           nv_isnull((Namval_t *)lastval)) {
-                    arith_error((char *)ERROR_dictionary(e_notset), nv_name((Namval_t *)lastval),
-                                3);
-                }
-                lastval = NULL;
+                node.isint = 0;
+                num = arith_store(ep, &cp, &node, &lastval, &ptr, num);
                 c = 0;
                 break;
             }
+            case A_PUSHL: {
+                cp = roundptr(ep, cp, Sflong_t);
+                num = *((Sflong_t *)cp);
+                cp += sizeof(Sflong_t);
+                *++sp = num;
+                *++tp = type = 0;
+                break;
+            }
             case A_PUSHF: {
                 cp = roundptr(ep, cp, Math_f);
                 *++sp = (Sfdouble_t)(cp - ep->code);
@@ -557,6 +874,7 @@ Sfdouble_t arith_exec(Arith_t *ep) {
                 break;
             }
         }
+    op_done:
         if (c) lastval = NULL;
         if (c & T_BINARY) {
             node.ptr = NULL;
@@ -571,6 +889,8 @@ Sfdouble_t arith_exec(Arith_t *ep) {
     return num;
 }
 
+Sfdouble_t arith_exec(Arith_t *ep) { return arith_execute(ep, NULL); }
+
 //
 // This returns operator tokens or A_REG or A_NUM.
 //
@@ -785,6 +1105,7 @@ again:
                     } else if ((int)lvalue.nargs & 040) {
                         userfun = T_NOFLOAT;
                     }
+                    vp->hasfloat = true;
                     sfputc(shp->stk, A_PUSHF);
                     stkpush(shp->stk, vp, fun, Math_f);
                     sfputc(shp->stk, 1 + (userfun == T_BINARY));
@@ -935,10 +1256,16 @@ again:
                 if (op == A_DIG || op == A_LIT || lvalue.isfloat == TYPE_LD)
 #endif
                 {
-                    sfputc(shp->stk, A_PUSHN);
                     if (vp->staksize++ >= vp->stakmaxsize) vp->stakmaxsize = vp->staksize;
-                    stkpush(shp->stk, vp, d, Sfdouble_t);
-                    sfputc(shp->stk, lvalue.isfloat);
+                    if (lvalue.isfloat == 0 && arith_isint(d)) {
+                        sfputc(shp->stk, A_PUSHL);
+                        stkpush(shp->stk, vp, (Sflong_t)d, Sflong_t);
+                    } else {
+                        vp->hasfloat = true;
+                        sfputc(shp->stk, A_PUSHN);
+                        stkpush(shp->stk, vp, d, Sfdouble_t);
+                        sfputc(shp->stk, lvalue.isfloat);
+                    }
                 }
 
                 // Check for function call.
@@ -999,6 +1326,7 @@ Arith_t *arith_compile(Shell_t *shp, const char *string, char **last,
     ep->emode = emode;
     ep->size = offset - sizeof(Arith_t);
     ep->staksize = cur.stakmaxsize + 1;
+    ep->intonly = !cur.hasfloat;
     if (last) *last = (char *)(cur.nextchr);
     if (nounset) sh_onoption(shp, SH_NOUNSET);
     return ep;
@@ -31,6 +31,7 @@
 #include <setjmp.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -68,6 +69,37 @@ struct Link {
     Namval_t *node;
 };
 
+//
+// Nodes and indexed array elements saved by sh_assignok() in a subshell are hashed on the node and
+// subscript so that later assignments to them do not have to search the list of saved nodes. An
+// assignment to one element of an indexed array of strings saves just the original value of that
+// element rather than a copy of the whole array.
+//
+struct Save {
+    Dtlink_t link;
+    Namval_t *node;   // saved node
+    long sub;         // subscript of a saved element, SAVE_NODE or SAVE_ELEMS
+    struct Link *lp;  // saved copy of the node for SAVE_NODE
+    char *val;        // original value of element sub, NULL if it was unset
+};
+
+#define SAVE_NODE (-1)   // the whole node is saved in lp
+#define SAVE_ELEMS (-2)  // at least one element of the node is saved
+
+static_fn void save_free(Dt_t *dt, void *obj, Dtdisc_t *disc) {
+    UNUSED(dt);
+    UNUSED(disc);
+    char *val = ((struct Save *)obj)->val;
+
+    if (val != Empty) free(val);
+    free(obj);
+}
+
+static Dtdisc_t _Savedisc = {.key = offsetof(struct Save, node),
+                             .size = offsetof(struct Save, lp) - offsetof(struct Save, node),
+                             .link = offsetof(struct Save, link),
+                             .freef = save_free};
+
 //
 // The following structure is used for command substitution and (...).
 //
@@ -77,6 +109,7 @@ static struct subshell {
     struct subshell *pipe;  // subshell where output goes to pipe on fork
     Dt_t *var;              // variable table at time of subshell
     struct Link *svar;      // save shell variable table
+    Dt_t *saved;            // nodes and elements saved in svar or by value, see struct Save
     Dt_t *sfun;             // function scope for subshell
     Dt_t *salias;           // alias scope for subshell
     Pathcomp_t *pathlist;   // for PATH variable
@@ -112,8 +145,8 @@ static struct subshell {
 static long subenv;
 
 //
-// This routine will turn the sftmp() file into a real /tmp file or pipe if the /tmp file create
-// fails.
+// This routine will turn the sftmp() file into a real file, an anonymous memory file where
+// memfd_create() is available else a /tmp file, or a pipe if the file create fails.
 //
 void sh_subtmpfile(Shell_t *shp) {
     if (sfset(sfstdout, 0, 0) & SF_STRING) {
@@ -128,10 +161,10 @@ void sh_subtmpfile(Shell_t *shp) {
             errormsg(SH_DICT, ERROR_system(1), e_toomany);
             __builtin_unreachable();
         }
-        // Popping a discipline forces a /tmp file create.
+        // Popping a discipline forces a memory or /tmp file create.
         if (shp->comsub != 1) sfdisc(sfstdout, SF_POPDISC);
         if ((fd = sffileno(sfstdout)) < 0) {
-            // Unable to create the /tmp file so use a pipe.
+            // Unable to create the file so use a pipe.
             int fds[3];
             Sfoff_t off;
             fds[2] = 0;
@@ -218,29 +251,81 @@ void sh_subfork(void) {
     }
 }
 
+//
+// Return the save entry for element <sub> of <np>, or for <np> itself if <sub> is SAVE_NODE or
+// SAVE_ELEMS, in subshell <sp>. It is added if <add> is set.
+//
+static_fn struct Save *save_find(struct subshell *sp, Namval_t *np, long sub, bool add) {
+    struct Save key, *svp;
+
+    if (!sp->saved) {
+        if (!add) return NULL;
+        sp->saved = dtopen(&_Savedisc, Dtset);
+    }
+    key.node = np;
+    key.sub = sub;
+    svp = dtmatch(sp->saved, &key.node);
+    if (svp || !add) return svp;
+    svp = calloc(1, sizeof(struct Save));
+    svp->node = np;
+    svp->sub = sub;
+    dtinsert(sp->saved, svp);
+    return svp;
+}
+
 bool nv_subsaved(Namval_t *np, bool table) {
     struct subshell *sp;
-    struct Link *lp, *lpprev;
+    struct Link *lp, **lpp;
+    struct Save *svp, *svnext;
     for (sp = (struct subshell *)subshell_data; sp; sp = sp->prev) {
-        lpprev = 0;
-        for (lp = sp->svar; lp; lpprev = lp, lp = lp->next) {
-            if (lp->node == np) {
-                if (table) {
-                    if (lpprev) {
-                        lpprev->next = lp->next;
-                    } else {
-                        sp->svar = lp->next;
+        if ((svp = save_find(sp, np, SAVE_NODE, false))) {
+            if (table) {
+                for (lpp = &sp->svar; (lp = *lpp); lpp = &lp->next) {
+                    if (lp == svp->lp) {
+                        *lpp = lp->next;
+                        free(lp);
+                        break;
                     }
-                    free(np);
-                    free(lp);
                 }
-                return true;
+                dtdelete(sp->saved, svp);
+                free(np);
             }
+            return true;
+        }
+        if (save_find(sp, np, SAVE_ELEMS, false)) {
+            if (table) {
+                for (svp = dtfirst(sp->saved); svp; svp = svnext) {
+                    svnext = dtnext(sp->saved, svp);
+                    if (svp->node == np) dtdelete(sp->saved, svp);
+                }
+                free(np);
+            }
+            return true;
         }
     }
     return false;
 }
 
+//
+// Put the saved elements of array <np> back into <mp>, the copy of <np> that is now saved instead.
+// The copy shares the strings of <np>, which were marked so that <np> does not free them, so a
+// string that is replaced in <mp> belongs to <np> again.
+//
+static_fn void save_elems(struct subshell *sp, Namval_t *np, Namval_t *mp) {
+    struct Save *svp, *svnext;
+    char *cp;
+
+    for (svp = dtfirst(sp->saved); svp; svp = svnext) {
+        svnext = dtnext(sp->saved, svp);
+        if (svp->node != np) continue;
+        if (svp->sub >= 0) {
+            if ((cp = nv_aiexchange(mp, svp->sub, svp->val))) nv_aiexchange(np, svp->sub, cp);
+            svp->val = NULL;
+        }
+        if (svp->sub != SAVE_NODE) dtdelete(sp->saved, svp);
+    }
+}
+
 //
 // This routine will make a copy of the given node in the layer created by the most recent
 // subshell_fork if the node hasn't already been copied.
@@ -253,7 +338,9 @@ Namval_t *sh_assignok(Namval_t *np, int add) {
     Dt_t *dp;
     Namval_t *mpnext;
     Namarr_t *ap;
-    int save;
+    struct Save *svp, *elems;
+    const char *val;
+    int save, sub;
 
     // Don't bother with this.
     if (!sp || !sp->shpwd || np == SH_LEVELNOD || np == L_ARGNOD || np == SH_SUBSCRNOD ||
@@ -265,12 +352,21 @@ Namval_t *sh_assignok(Namval_t *np, int add) {
 
     if ((ap = nv_arrayptr(np)) && (mp = nv_opensub(np))) {
         shp->last_root = ap->table;
-        sh_assignok(mp, add);
+        sh_assignok(mp, add ? 1 : 0);
         if (!add || is_associative(ap)) return np;
     }
-    for (lp = sp->svar; lp; lp = lp->next) {
-        if (lp->node == np) return np;
+    if (save_find(sp, np, SAVE_NODE, false)) return np;
+    if (add == SH_ASSIGN_ELEM && ap && (sub = nv_aisave(np, &val)) >= 0) {
+        if (!save_find(sp, np, sub, false)) {
+            svp = save_find(sp, np, sub, true);
+            svp->val = val && val != Empty ? strdup(val) : (char *)val;
+            save_find(sp, np, SAVE_ELEMS, true);
+        }
+        return np;
     }
+    // Arrays with saved elements are copied, as they would have been when the first element was
+    // assigned, rather than moved out of the subshell.
+    if ((elems = save_find(sp, np, SAVE_ELEMS, false))) add = 1;
     // First two pointers use linkage from np.
     lp = malloc(sizeof(*np) + 2 * sizeof(void *));
     memset(lp, 0, sizeof(*mp) + 2 * sizeof(void *));
@@ -298,11 +394,13 @@ Namval_t *sh_assignok(Namval_t *np, int add) {
     mp = (Namval_t *)&lp->dict;
     lp->next = subshell_data->svar;
     subshell_data->svar = lp;
+    save_find(sp, np, SAVE_NODE, true)->lp = lp;
     save = shp->subshell;
     shp->subshell = 0;
     mp->nvname = np->nvname;
     if (nv_isattr(np, NV_NOFREE)) nv_onattr(mp, NV_CLONED);
     nv_clone(np, mp, (add ? (nv_isnull(np) ? 0 : NV_NOFREE) | NV_ARRAY : NV_MOVE));
+    if (elems) save_elems(sp, np, mp);
     shp->subshell = save;
     return np;
 }
@@ -312,6 +410,7 @@ Namval_t *sh_assignok(Namval_t *np, int add) {
 //
 static_fn void nv_restore(struct subshell *sp) {
     struct Link *lp, *lq;
+    struct Save *svp;
     Namval_t *mp, *np;
     const char *save = sp->shpwd;
     Namval_t *mpnext;
@@ -360,6 +459,15 @@ static_fn void nv_restore(struct subshell *sp) {
         free(lp);
         sp->svar = lq;
     }
+    if (sp->saved) {
+        for (svp = dtfirst(sp->saved); svp; svp = dtnext(sp->saved, svp)) {
+            if (svp->sub < 0 || !svp->node->nvname) continue;
+            free(nv_aiexchange(svp->node, svp->sub, svp->val));
+            svp->val = NULL;
+        }
+        dtclose(sp->saved);
+        sp->saved = NULL;
+    }
     sp->shpwd = save;
 }
 
@@ -676,6 +784,7 @@ Sfio_t *sh_subshell(Shell_t *shp, Shnode_t *t, volatile int flags, int comsub) {
             shp->alias_tree = dtview(sp->salias, 0);
             subshell_table_unset(sp->salias, 0);
             dtclose(sp->salias);
+            shp->aliasgen++;
         }
         if (sp->sfun) {
             shp->fun_tree = dtview(sp->sfun, 0);
@@ -42,9 +42,11 @@ static_fn int dump_p_tree(const Shnode_t *);
 static_fn int dump_p_string(const char *);
 
 static Sfio_t *outfile;
+static int outversion;
 
-int sh_tdump(Sfio_t *out, const Shnode_t *t) {
+int sh_tdump(Sfio_t *out, const Shnode_t *t, int version) {
     outfile = out;
+    outversion = version;
     return dump_p_tree(t);
 }
 
@@ -106,6 +108,12 @@ static_fn int dump_p_tree(const Shnode_t *t) {
         }
         case TFUN: {
             if (sfputu(outfile, t->funct.functline) < 0) return -1;
+            if (outversion > 3) {
+                const struct functnod *fp = NULL;
+                if (t->funct.functstak) fp = (struct functnod *)(t->funct.functstak + 1);
+                if (sfputl(outfile, t->funct.functloc) < 0) return -1;
+                if (sfputu(outfile, fp ? fp->functline : 0) < 0) return -1;
+            }
             if (dump_p_string(t->funct.functnam) < 0) return -1;
             if (dump_p_tree(t->funct.functtre) < 0) return -1;
             return dump_p_tree((Shnode_t *)t->funct.functargs);
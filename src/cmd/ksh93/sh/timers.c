@@ -23,33 +23,50 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "defs.h"
 #include "error.h"
 #include "fault.h"
 
+// Pending timers are kept in a binary min-heap ordered by wakeup time so that adding, deleting
+// and firing a timer costs O(log n) rather than a scan of every timer. A single interval timer
+// is armed for the earliest wakeup in the heap.
 struct _timer {
     double wakeup;
     double incr;
-    struct _timer *next;
+    struct _timer *next;  // link on the free list
+    int slot;             // index in tpheap[] or -1 if the timer is not pending
     void (*action)(void *);
     void *handle;
 };
 
-#define IN_ADDTIMEOUT 1
+#define IN_ADDTIMEOUT 1  // the heap is being changed outside the signal handler
 #define IN_SIGALRM 2
 #define DEFER_SIGALRM 4
 #define SIGALRM_CALL 8
 
-static Timer_t *tptop, *tpmin, *tpfree;
+static Timer_t **tpheap, *tpfree;
+static int tpcount, tpsize;
+static double tparmed;  // wakeup time the interval timer is set for or 0
 static char time_state;
 
+//
+// Return the current time in seconds. A monotonic clock is used when there is one so that
+// setting the system clock does not make pending timers fire early or late.
+//
 static_fn double getnow(void) {
     double now;
+#if _lib_clock_gettime && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = ts.tv_sec + 1.e-9 * ts.tv_nsec;
+#else
     struct timeval tp;
     timeofday(&tp);
     now = tp.tv_sec + 1.e-6 * tp.tv_usec;
+#endif
     return now + .001;
 }
 
@@ -73,6 +90,60 @@ static_fn double setalarm(double t) {
     return t;
 }
 
+//
+// Move the timer at heap slot <i> toward the root until its parent does not wake up later.
+//
+static_fn void heap_up(int i) {
+    Timer_t *tp = tpheap[i];
+    int parent;
+
+    while (i > 0 && tpheap[parent = (i - 1) / 2]->wakeup > tp->wakeup) {
+        tpheap[i] = tpheap[parent];
+        tpheap[i]->slot = i;
+        i = parent;
+    }
+    tpheap[i] = tp;
+    tp->slot = i;
+}
+
+//
+// Move the timer at heap slot <i> toward the leaves until neither child wakes up earlier.
+//
+static_fn void heap_down(int i) {
+    Timer_t *tp = tpheap[i];
+    int child;
+
+    while ((child = 2 * i + 1) < tpcount) {
+        if (child + 1 < tpcount && tpheap[child + 1]->wakeup < tpheap[child]->wakeup) child++;
+        if (tpheap[child]->wakeup >= tp->wakeup) break;
+        tpheap[i] = tpheap[child];
+        tpheap[i]->slot = i;
+        i = child;
+    }
+    tpheap[i] = tp;
+    tp->slot = i;
+}
+
+//
+// Take timer <tp> out of the heap and put it on the free list.
+//
+static_fn void heap_remove(Timer_t *tp) {
+    int i = tp->slot;
+
+    tp->slot = -1;
+    tp->next = tpfree;
+    tpfree = tp;
+    if (i != --tpcount) {
+        tpheap[i] = tpheap[tpcount];
+        tpheap[i]->slot = i;
+        if (i > 0 && tpheap[(i - 1) / 2]->wakeup > tpheap[i]->wakeup) {
+            heap_up(i);
+        } else {
+            heap_down(i);
+        }
+    }
+}
+
 //
 // Signal handler for alarm call.
 //
@@ -80,17 +151,17 @@ static_fn double setalarm(double t) {
 // to timing issues. See https://github.com/att/ast/issues/633
 static_fn void sigalrm(int sig, siginfo_t *info, void *context) {
     UNUSED(context);
-    Timer_t *tp, *tplast, *tpold, *tpnext;
+    Timer_t *tp;
     double now;
-    static double left = 0;
     Shell_t *shp = sh_getinterp();
 
     set_trapinfo(shp, sig, info);
 
     if (time_state & SIGALRM_CALL) {
         time_state &= ~SIGALRM_CALL;
-    } else if (alarm(0)) {
-        kill(getpid(), SIGALRM | SH_TRAP);
+    } else {
+        tparmed = 0;
+        if (alarm(0)) kill(getpid(), SIGALRM | SH_TRAP);
     }
     if (time_state) {
         if (time_state & IN_ADDTIMEOUT) time_state |= DEFER_SIGALRM;
@@ -99,62 +170,56 @@ static_fn void sigalrm(int sig, siginfo_t *info, void *context) {
     }
     time_state |= IN_SIGALRM;
     sh_sigaction(SIGALRM, SIG_UNBLOCK);
-    while (1) {
+    while (tpcount) {
         now = getnow();
-        tpold = tpmin = 0;
-        for (tplast = 0, tp = tptop; tp; tp = tpnext) {
-            tpnext = tp->next;
-            if (tp->action) {
-                if (tp->wakeup <= now) {
-                    if (!tpold || tpold->wakeup > tp->wakeup) tpold = tp;
-                } else {
-                    if (!tpmin || tpmin->wakeup > tp->wakeup) tpmin = tp;
-                }
-                tplast = tp;
-            } else {
-                if (tplast) {
-                    tplast->next = tp->next;
-                } else {
-                    tptop = tp->next;
-                }
-                tp->next = tpfree;
-                tpfree = tp;
-            }
-        }
-        if ((tp = tpold) && tp->incr) {
+        tp = tpheap[0];
+        if (tp->wakeup > now) {
+            tp = 0;
+        } else if (!tp->action) {
+            // Deleted from inside another signal handler.
+            heap_remove(tp);
+            continue;
+        } else if (tp->incr) {
             while ((tp->wakeup += tp->incr) <= now) {
                 ;  // empty loop
             }
-            if (!tpmin || tpmin->wakeup > tp->wakeup) tpmin = tp;
-        }
-        if (tpmin && (left == 0 || (tp && tpmin->wakeup < (now + left)))) {
-            if (left == 0) sh_signal(SIGALRM, sigalrm);
-            left = setalarm(tpmin->wakeup - now);
-            if (left && (now + left) < tpmin->wakeup) {
-                setalarm(left);
-            } else {
-                left = tpmin->wakeup - now;
-            }
-        }
-        if (tp) {
-            void (*action)(void *);
-            action = tp->action;
-            if (!tp->incr) tp->action = 0;
-            errno = EINTR;
-            time_state &= ~IN_SIGALRM;
-            (*action)(tp->handle);
-            time_state |= IN_SIGALRM;
+            heap_down(0);
         } else {
-            break;
+            heap_remove(tp);
+        }
+        // Arm the interval timer for the next wakeup before running the action since the
+        // action may not return.
+        if (tpcount && tpheap[0]->wakeup != tparmed) {
+            tparmed = tpheap[0]->wakeup;
+            setalarm(tparmed > now ? tparmed - now : 0.001);
         }
+        if (!tp) break;
+        void (*action)(void *) = tp->action;
+        void *handle = tp->handle;
+        if (!tp->incr) tp->action = 0;
+        errno = EINTR;
+        time_state &= ~IN_SIGALRM;
+        (*action)(handle);
+        time_state |= IN_SIGALRM;
     }
-    if (!tpmin) {
+    if (!tpcount) {
         sh_signal(SIGALRM, (sh.sigflag[SIGALRM] & SH_SIGFAULT) ? sh_fault : (sh_sigfun_t)(SIG_DFL));
     }
     time_state &= ~IN_SIGALRM;
     errno = EINTR;
 }
 
+//
+// Run a SIGALRM that arrived while the heap was being changed.
+//
+static_fn void sigalrm_deferred(void) {
+    time_state &= ~IN_ADDTIMEOUT;
+    if (time_state & DEFER_SIGALRM) {
+        time_state = SIGALRM_CALL;
+        kill(getpid(), SIGALRM);
+    }
+}
+
 static_fn void oldalrm(void *handle) {
     sh_sigfun_t fn = *(sh_sigfun_t *)handle;
     free(handle);
@@ -168,6 +233,13 @@ Timer_t *sh_timeradd(unsigned long msec, int flags, void (*action)(void *), void
 
     t = ((double)msec) / 1000.;
     if (t <= 0 || !action) return NULL;
+    if (tpcount == tpsize) {
+        int size = tpsize ? 2 * tpsize : 16;
+        Timer_t **heap = realloc(tpheap, size * sizeof(Timer_t *));
+        if (!heap) return NULL;
+        tpheap = heap;
+        tpsize = size;
+    }
     tp = tpfree;
     if (tp) {
         tpfree = tp->next;
@@ -178,11 +250,12 @@ Timer_t *sh_timeradd(unsigned long msec, int flags, void (*action)(void *), void
     tp->incr = (flags ? t : 0);
     tp->action = action;
     tp->handle = handle;
+    tp->next = 0;
     time_state |= IN_ADDTIMEOUT;
-    tp->next = tptop;
-    tptop = tp;
-    if (!tpmin || tp->wakeup < tpmin->wakeup) {
-        tpmin = tp;
+    tpheap[tpcount] = tp;
+    heap_up(tpcount++);
+    if (tp->slot == 0) {
+        tparmed = tp->wakeup;
         fn = sh_signal(SIGALRM, sigalrm);
         if ((t = setalarm(t)) > 0 && fn && fn != sigalrm) {
             sh_sigfun_t *hp = malloc(sizeof(sh_sigfun_t));
@@ -191,16 +264,9 @@ Timer_t *sh_timeradd(unsigned long msec, int flags, void (*action)(void *), void
                 sh_timeradd((long)(1000 * t), 0, oldalrm, hp);
             }
         }
-        tp = tptop;
-    } else if (tpmin && !tpmin->action) {
-        time_state |= DEFER_SIGALRM;
-    }
-    time_state &= ~IN_ADDTIMEOUT;
-    if (time_state & DEFER_SIGALRM) {
-        time_state = SIGALRM_CALL;
-        kill(getpid(), SIGALRM);
-        if (tp != tptop) tp = 0;
     }
+    sigalrm_deferred();
+    if (!tp->action) tp = 0;
     return tp;
 }
 
@@ -211,12 +277,28 @@ void timerdel(void *handle) {
     Timer_t *tp = (Timer_t *)handle;
     if (tp) {
         tp->action = 0;
-    } else {
-        for (tp = tptop; tp; tp = tp->next) tp->action = 0;
-        if (tpmin) {
-            tpmin = 0;
+        // The heap cannot be changed while the handler is using it; the handler drops the
+        // timer when it reaches it.
+        if (tp->slot < 0 || (time_state & (IN_ADDTIMEOUT | IN_SIGALRM))) return;
+        time_state |= IN_ADDTIMEOUT;
+        heap_remove(tp);
+        if (tpcount == 0) {
+            tparmed = 0;
             setalarm((double)0);
+            sh_signal(SIGALRM,
+                      (sh.sigflag[SIGALRM] & SH_SIGFAULT) ? sh_fault : (sh_sigfun_t)(SIG_DFL));
+        }
+        sigalrm_deferred();
+    } else {
+        time_state |= IN_ADDTIMEOUT;
+        while (tpcount) {
+            tp = tpheap[tpcount - 1];
+            tp->action = 0;
+            heap_remove(tp);
         }
+        tparmed = 0;
+        setalarm((double)0);
         sh_signal(SIGALRM, (sh.sigflag[SIGALRM] & SH_SIGFAULT) ? sh_fault : (sh_sigfun_t)(SIG_DFL));
+        time_state &= ~(IN_ADDTIMEOUT | DEFER_SIGALRM);
     }
 }
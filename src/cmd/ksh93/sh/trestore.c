@@ -45,12 +45,14 @@ static_fn char *r_string(Stk_t *);
 static_fn void r_comarg(Shell_t *, struct comnod *);
 
 static Sfio_t *infile;
+static int inversion;
 
 #define getnode(s, type) (stkalloc((s), sizeof(struct type)))
 
-Shnode_t *sh_trestore(Shell_t *shp, Sfio_t *in) {
+Shnode_t *sh_trestore(Shell_t *shp, Sfio_t *in, int version) {
     Shnode_t *t;
     infile = in;
+    inversion = version;
     t = r_tree(shp);
     return t;
 }
@@ -139,15 +141,22 @@ static_fn Shnode_t *r_tree(Shell_t *shp) {
                 t->sw.swio = NULL;
             }
             t->sw.swlst = r_switch(shp);
+            t->sw.swidx = sh_swindex(shp->stk, t->sw.swlst);
             break;
         }
         case TFUN: {
             Sfio_t *savstk;
             struct slnod *slp;
             struct functnod *fp;
+            off_t loc = -1;
+            int64_t size = 0;
             t = getnode(shp->stk, functnod);
-            t->funct.functloc = -1;
             t->funct.functline = sfgetu(infile);
+            if (inversion > 3) {
+                loc = sfgetl(infile);
+                size = sfgetu(infile);
+            }
+            t->funct.functloc = loc;
             t->funct.functnam = r_string(shp->stk);
             savstk = stkopen(STK_SMALL);
             savstk = stkinstall(savstk, 0);
@@ -158,6 +167,7 @@ static_fn Shnode_t *r_tree(Shell_t *shp) {
             fp = (struct functnod *)(slp + 1);
             memset(fp, 0, sizeof(*fp));
             fp->functtyp = TFUN | FAMP;
+            fp->functline = size;
             if (shp->st.filename) fp->functnam = stkcopy(shp->stk, shp->st.filename);
             t->funct.functtre = r_tree(shp);
             t->funct.functstak = slp;
@@ -515,6 +515,28 @@ static_fn int xec_p_switch(Shell_t *shp, struct regnod *reg) {
     return n;
 }
 
+//
+// Return the literal pattern equal to r with the first case arm, NULL if there is none.
+//
+static_fn struct swlit *xec_swlookup(struct swindex *sp, const char *r) {
+    unsigned int h = sh_swhash(r);
+    struct swlit *lp;
+
+    for (lp = sp->table[h & sp->mask]; lp; lp = lp->next) {
+        if (lp->hval == h && !strcmp(lp->val, r)) break;
+    }
+    return lp;
+}
+
+//
+// Match r of length n against the SW_SIMPLE pattern s.
+//
+static_fn bool xec_swsimple(const struct swpat *pp, const char *s, const char *r, size_t n) {
+    if (!pp->star) return n == pp->plen && !memcmp(r, s, n);
+    return n >= pp->plen + pp->slen && !memcmp(r, s, pp->plen) &&
+           !memcmp(r + n - pp->slen, s + pp->plen + 1, pp->slen);
+}
+
 #define OPTIMIZE_FLAG (ARG_OPTIMIZE)
 #define OPTIMIZE (flags & OPTIMIZE_FLAG)
 
@@ -977,6 +999,12 @@ int sh_exec(Shell_t *shp, const Shnode_t *t, int flags) {
     if (was_errexit & flags) sh_onstate(shp, SH_ERREXIT);
     if (was_monitor & flags) sh_onstate(shp, SH_MONITOR);
     type = t->tre.tretyp;
+    // File status remembered by the operators of a [[ ... ]] is only good until something other
+    // than the rest of that expression runs.
+    if (!(type & TTEST) || ((type & COMMSK) != TTST && (type & COMMSK) != TAND &&
+                            (type & COMMSK) != TORF)) {
+        test_forget();
+    }
     if (!shp->intrap) shp->oldexit = shp->exitval;
     shp->exitval = 0;
     shp->lastsig = 0;
@@ -1587,6 +1615,8 @@ int sh_exec(Shell_t *shp, const Shnode_t *t, int flags) {
                     break;
                 }
 #else   // USE_SPAWN
+                // Let the child inherit the cached environment instead of generating its own.
+                if (com && !t->com.comset) sh_envprefork(shp);
                 parent = sh_fork(shp, type, &jobid);
 #endif  // USE_SPAWN
             }
@@ -2175,6 +2205,29 @@ int sh_exec(Shell_t *shp, const Shnode_t *t, int flags) {
                 av[3] = 0;
                 sh_debug(shp, trap, NULL, NULL, av, 0);
             }
+            // With an index the literal patterns before the first arm with a literal equal to r
+            // are skipped, and simple patterns are compared without strmatch().
+            struct swindex *sp = tt->sw.swidx;
+            struct swpat *pp = NULL;
+            struct swlit *lp;
+            int arm = 0;
+            int lit = INT_MAX;
+            bool simple = false;
+            size_t rlen = 0;
+            if (sp) {
+                pp = sp->pat;
+                if ((lp = xec_swlookup(sp, r))) {
+                    lit = lp->arm;
+                    if (lp->skip) {
+                        // Only literal patterns before this arm, go straight to it.
+                        t = (Shnode_t *)lp->reg;
+                        arm = lit;
+                        pp += lp->pat;
+                    }
+                }
+                simple = !mbwide() || ast.locale.is_utf8;
+                rlen = strlen(r);
+            }
             while (t) {
                 struct argnod *rex = (struct argnod *)t->reg.regptr;
 #if SHOPT_COSHELL
@@ -2183,27 +2236,35 @@ int sh_exec(Shell_t *shp, const Shnode_t *t, int flags) {
                     continue;
                 }
 #endif  // SHOPT_COSHELL
-                while (rex) {
+                for (; rex; rex = rex->argnxt.ap, pp = pp ? pp + 1 : NULL) {
                     char *s;
-                    if (rex->argflag & ARG_MAC) {
-                        s = sh_macpat(shp, rex, OPTIMIZE | ARG_EXP | ARG_CASE);
-                        while (*s == '\\' && s[1] == 0) s += 2;
+                    bool match;
+                    if (pp && pp->kind == SW_LITERAL && arm < lit) continue;
+                    if (pp && pp->kind == SW_SIMPLE && simple) {
+                        match = xec_swsimple(pp, rex->argval, r, rlen);
                     } else {
-                        s = rex->argval;
+                        if (rex->argflag & ARG_MAC) {
+                            s = sh_macpat(shp, rex, OPTIMIZE | ARG_EXP | ARG_CASE);
+                            while (*s == '\\' && s[1] == 0) s += 2;
+                        } else {
+                            s = rex->argval;
+                        }
+                        type = (rex->argflag & ARG_RAW);
+                        match = (type && strcmp(r, s) == 0) || (!type && strmatch(r, s));
                     }
-                    type = (rex->argflag & ARG_RAW);
-                    if ((type && strcmp(r, s) == 0) || (!type && strmatch(r, s))) {
+                    if (match) {
                         do {
                             sh_exec(shp, t->reg.regcom,
                                     (t->reg.regflag ? (flags & sh_state(SH_ERREXIT)) : flags));
                         } while (t->reg.regflag && (t = (Shnode_t *)t->reg.regnxt));
                         t = 0;
                         break;
-                    } else {
-                        rex = rex->argnxt.ap;
                     }
                 }
-                if (t) t = (Shnode_t *)t->reg.regnxt;
+                if (t) {
+                    t = (Shnode_t *)t->reg.regnxt;
+                    arm++;
+                }
             }
             break;
         }
@@ -2444,6 +2505,7 @@ int sh_exec(Shell_t *shp, const Shnode_t *t, int flags) {
                         argv[4] = 0;
                         sh_debug(shp, trap, NULL, NULL, argv, 0);
                     }
+                    test_remember();
                     n = test_unop(shp, n, left);
                 } else if (type & TBINARY) {
                     char *op;
@@ -2459,6 +2521,7 @@ int sh_exec(Shell_t *shp, const Shnode_t *t, int flags) {
                         argv[5] = 0;
                         sh_debug(shp, trap, NULL, NULL, argv, pattern);
                     }
+                    test_remember();
                     n = test_binop(shp, n, left, right);
                     if (traceon) {
                         sfprintf(sfstderr, "%s %s ", sh_fmtq(left), op);
@@ -3295,9 +3358,11 @@ int sh_eval(Shell_t *shp, Sfio_t *iop, int mode) {
     int binscript = shp->binscript;
     char comsub = shp->comsub;
     Sfio_t *iosaved = io_save;
+    Sfio_t *dump = shp->treedump;
 
     io_save = iop;  // preserve correct value across longjmp
     shp->binscript = 0;
+    shp->treedump = NULL;
     shp->comsub = 0;
 #define SH_TOPFUN 0x8000  // this is a temporary tksh hack
     if (mode & SH_TOPFUN) {
@@ -3314,6 +3379,7 @@ int sh_eval(Shell_t *shp, Sfio_t *iop, int mode) {
             if (traceon) sh_offoption(shp, SH_XTRACE);
         }
         t = sh_parse(shp, iop, (mode & (SH_READEVAL | SH_FUNEVAL)) ? mode & SH_FUNEVAL : SH_NL);
+        if (dump && t) sh_tdump(dump, t, SH_TDUMPVERSION);
         if (!(mode & SH_FUNEVAL) || !sfreserve(iop, 0, 0)) {
             if (!(mode & SH_READEVAL)) sfclose(iop);
             io_save = 0;
@@ -3330,6 +3396,8 @@ int sh_eval(Shell_t *shp, Sfio_t *iop, int mode) {
         if (!io_save) break;
     }
     sh_popcontext(shp, buffp);
+    // Hand the tree stream back only if every command was parsed.
+    if (jmpval == 0) shp->treedump = dump;
     shp->binscript = binscript;
     shp->comsub = comsub;
     if (traceon) sh_onoption(shp, SH_XTRACE);
@@ -133,3 +133,22 @@ foo=()
 foo+=(x=1 y=2)
 foo+=(x=3 y=4)
 [[ ${!foo[@]} == '0 1' ]] || log_error  'append to unset array of types not working'
+
+# Repeated appends grow the value in place and keep its length.
+unset s
+s=ab
+for ((i = 0; i < 5000; i++))
+do
+    s+=xyz
+done
+[[ ${#s} == 15002 && ${s:0:5} == abxyz && ${s: -4} == zxyz ]] || log_error "appending in a loop gives ${#s} characters"
+s=short
+[[ ${#s} == 5 && $s == short ]] || log_error 'assignment after appends keeps the old length'
+s+=$s
+s+=$s
+[[ $s == shortshortshortshort && ${#s} == 20 ]] || log_error "appending a variable to itself gives '$s'"
+unset s
+typeset -a sa=(one two)
+sa[1]+=three
+sa[1]+=four
+[[ ${sa[1]} == twothreefour && ${#sa[1]} == 12 ]] || log_error "append to array element gives '${sa[1]}'"
@@ -1073,3 +1073,20 @@ function f
 [[ $(( (2**32) << 67 )) == 0 ]] || log_error 'left shift count 67 is non-zero'
 
 [[ 0x123 -eq 0x122+0x1 ]] || log_error "[[...]] does not support math operations on hexadecimal numbers"
+
+# Integer expressions are evaluated in 64 bit integer arithmetic and must fall back to floating
+# point exactly where the long double evaluator would give a different answer.
+[[ $(( 9223372036854775807 + 1 )) == 9223372036854775808 ]] ||
+    log_error 'integer overflow in addition does not fall back to floating point'
+[[ $(( 4611686018427387904 * 4 )) == 1.84467440737095516e+19 ]] ||
+    log_error 'integer overflow in multiplication does not fall back to floating point'
+[[ $(( -7 / 2 )) == -4 && $(( 7 / -2 )) == -4 && $(( -7 % 2 )) == -1 ]] ||
+    log_error 'integer division does not round toward negative infinity'
+x=$(( 123456789012 * 1000 + 7 ))
+[[ $x == 123456789012007 ]] || log_error "large integer result is $x, should be 123456789012007"
+typeset -si s=32767
+(( s++ ))
+[[ $s == -32768 ]] || log_error "short integer should wrap to -32768, got $s"
+float f=1.5
+integer n=3
+[[ $(( n * 2 + f )) == 7.5 ]] || log_error 'float variable in integer expression gives wrong result'
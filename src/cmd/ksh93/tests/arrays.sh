@@ -872,3 +872,76 @@ unset foo bar
 typeset -a foo=([1]=w [2]=x) bar=(a b c)
 foo+=("${bar[@]}")
 [[ $(typeset -p foo) == 'typeset -a foo=([1]=w [2]=x [3]=a [4]=b [5]=c)' ]] || log_error 'Appending does not work if array contains empty indexes'
+
+# Indexed arrays with large, widely spaced subscripts are stored sparsely.
+unset sa
+sa[2000000000]=x sa[5]=y sa[1999999999]=z
+[[ ${!sa[@]} == '5 1999999999 2000000000' ]] || log_error "sparse array subscripts are ${!sa[@]}"
+[[ ${sa[@]} == 'y z x' ]] || log_error "sparse array values are ${sa[@]}"
+[[ ${#sa[@]} == 3 ]] || log_error "sparse array has ${#sa[@]} elements, should be 3"
+[[ ${sa[-1]} == x ]] || log_error "\${sa[-1]} for sparse array is ${sa[-1]}, should be x"
+unset sa[1999999999]
+[[ $(typeset -p sa) == 'typeset -a sa=([5]=y [2000000000]=x)' ]] ||
+    log_error "unset element of sparse array gives $(typeset -p sa)"
+(sa[7]=w; [[ ${!sa[@]} == '5 7 2000000000' ]]) || log_error 'assignment to sparse array in subshell fails'
+[[ ${!sa[@]} == '5 2000000000' ]] || log_error 'assignment to sparse array in subshell not undone'
+
+unset sa
+sa[100000]=last
+for ((i = 0; i < 30000; i++))
+do
+    sa[i]=$i
+done
+[[ ${#sa[@]} == 30001 && ${sa[29999]} == 29999 && ${sa[100000]} == last ]] ||
+    log_error 'sparse array that fills in loses elements'
+
+unset sa
+integer -a sa
+sa[1000000]=3 sa[5]=2
+(( sa[1000000] * sa[5] == 6 )) || log_error 'arithmetic on sparse integer array fails'
+
+# Associative arrays are hashed but their subscripts are still visited in sorted order.
+unset aa
+typeset -A aa
+for sub in 9 3 zz 1 aa 77 b
+do
+    aa[$sub]=$sub
+done
+[[ ${!aa[@]} == '1 3 77 9 aa b zz' ]] || log_error "associative array subscripts are ${!aa[@]}"
+for ((i = 0; i < 200; i++))
+do
+    aa[k$i]=$i
+    [[ ${aa[3]} == 3 ]] || break
+done
+(( ${#aa[@]} == 207 )) || log_error "associative array has ${#aa[@]} elements, should be 207"
+set -- "${!aa[@]}"
+[[ $1 == 1 && $5 == aa && $6 == b && $7 == k0 && $8 == k1 && $9 == k10 && ${@: -1} == zz ]] ||
+    log_error 'associative array subscripts not sorted after inserts'
+unset aa[k1]
+[[ $(typeset -p aa) == 'typeset -A aa=([1]=1 [3]=3 [77]=77 [9]=9 [aa]=aa [b]=b [k0]=0 [k10]=10 '* ]] ||
+    log_error 'typeset -p of associative array not sorted'
+function lscope
+{
+    typeset -A aa=([a1]=x)
+    aa[0]=y
+    print -r -- "${!aa[@]}"
+}
+[[ $(lscope) == '0 a1' ]] || log_error "associative array in function scope has subscripts $(lscope)"
+set --
+# A table that is walked between runs of lookups stays sorted and complete.
+for ((j = 0; j < 4; j++))
+do
+    n=0
+    for sub in "${!aa[@]}"
+    do
+        [[ ${aa[$sub]} == ${sub#k} ]] && ((n++))
+    done
+    for ((i = 0; i < 300; i++))
+    do
+        [[ ${aa[k$((i % 200))]} ]] || [[ $i == 1 ]] || break
+    done
+    set -- "${!aa[@]}"
+    [[ $1 == 1 && $7 == k0 && $8 == k10 && ${@: -1} == zz && $# == 206 && $n == 206 ]] || break
+done
+(( j == 4 )) || log_error "associative array not sorted after walk $j and lookups"
+set --
@@ -581,3 +581,65 @@ set -a
 foo=${bar:=baz}
 env | grep -q bar || log_error 'Variable bar should be exported'
 set +a
+
+# The environment passed to commands must follow every change to exported variables.
+unset foo bar
+export foo=one
+[[ $(env | grep '^foo=') == foo=one ]] || log_error 'exported variable not in environment'
+[[ $(env | grep '^foo=') == foo=one ]] || log_error 'exported variable not in reused environment'
+foo=two
+[[ $(env | grep '^foo=') == foo=two ]] || log_error 'new value of exported variable not in environment'
+export bar=three
+[[ $(env | grep -c '^\(foo\|bar\)=') == 2 ]] || log_error 'newly exported variable not in environment'
+typeset +x bar
+[[ $(env | grep '^bar=') ]] && log_error 'variable still in environment after typeset +x'
+unset foo
+[[ $(env | grep '^foo=') ]] && log_error 'variable still in environment after unset'
+export foo=four
+function setfoo
+{
+    typeset foo=five
+    export foo
+    env | grep '^foo='
+}
+[[ $(setfoo) == foo=five ]] || log_error 'exported local variable not in environment'
+[[ $(env | grep '^foo=') == foo=four ]] || log_error 'environment not restored after function returns'
+[[ $(foo=six env | grep '^foo=') == foo=six ]] || log_error 'command prefix assignment not in environment'
+[[ $(env | grep '^foo=') == foo=four ]] || log_error 'command prefix assignment left in environment'
+unset foo bar
+export foo=seven
+env > /dev/null
+function foo.get { .sh.value=eight; }
+[[ $(env | grep '^foo=') == foo=eight ]] || log_error 'get discipline on exported variable not in environment'
+unset -f foo.get
+unset foo
+
+# Commands run with an unchanged environment reuse the list generated for the first one. Exported
+# variables this script has with dynamic values would keep it from being kept, so use a new shell.
+$SHELL -c '
+    function log_error { print -r -- "$1"; }
+    export foo=nine
+    integer hits=${.sh.stats.env_cachehits}
+    for i in 1 2 3 4 5
+    do
+        env > /dev/null
+    done
+    (( ${.sh.stats.env_cachehits} >= hits + 4 )) || log_error "environment not reused across commands"
+    hits=${.sh.stats.env_cachehits}
+    foo=ten
+    env > /dev/null
+    (( ${.sh.stats.env_cachehits} > hits )) || log_error "environment not patched after an assignment"
+    [[ $(env | grep "^foo=") == foo=ten ]] || log_error "patched environment has the wrong value"
+    for i in 1 2 3 4 5 6 7 8 9 10
+    do
+        export foo$i=$i
+    done
+    [[ $(env | grep -c "^foo[0-9]*=") == 11 ]] || log_error "variables exported in a row not in environment"
+    typeset -i foo1
+    [[ $(env | grep "^A__z=") == *foo1* ]] || log_error "attributes of exported variable not in environment"
+    foo1=7
+    [[ $(env | grep "^foo1=") == foo1=7 ]] || log_error "new value of exported integer not in environment"
+' | while read -r msg
+do
+    log_error "$msg"
+done
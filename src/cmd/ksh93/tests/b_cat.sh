@@ -132,3 +132,38 @@ expect="a^Ib"
 actual=$(cat this_file_does_not_exist 2>&1)
 expect="this_file_does_not_exist: cannot open [No such file or directory]"
 [[ "$actual" =~ "$expect" ]] || log_error "cat should give an error on non-existent files" "$expect" "$actual"
+
+# ==========
+# Copies between plain file descriptors may be done by the kernel. The result must be the same as
+# copying through the stream buffers, including the file offsets left behind for the next command.
+integer i
+for (( i = 0; i < 2000; i++ ))
+do  print "line $i of a file big enough to need more than one buffer"
+done > "$TEST_DIR/big_file"
+cat "$TEST_DIR/big_file" > "$TEST_DIR/copy_file"
+cmp -s "$TEST_DIR/big_file" "$TEST_DIR/copy_file" || log_error "cat of a file to a file differs"
+cat "$TEST_DIR/big_file" >> "$TEST_DIR/copy_file"
+actual=$(wc -c < "$TEST_DIR/copy_file")
+expect=$(( 2 * $(wc -c < "$TEST_DIR/big_file") ))
+(( actual == expect )) || log_error "cat appending to a file failed" "$expect" "$actual"
+{ print first; cat "$TEST_DIR/big_file"; print last; } > "$TEST_DIR/copy_file"
+actual=$(sed -n '1p;$p' "$TEST_DIR/copy_file")
+expect=$'first\nlast'
+[[ $actual == "$expect" ]] || log_error "cat between other writes to a file failed" "$expect" "$actual"
+{ read -r; cat; } < "$TEST_DIR/big_file" > "$TEST_DIR/copy_file"
+actual=$(head -n 1 "$TEST_DIR/copy_file")
+expect="line 1 of a file big enough to need more than one buffer"
+[[ $actual == "$expect" ]] || log_error "cat after a partial read of a shared file failed" "$expect" "$actual"
+actual=$(cat "$TEST_DIR/big_file" | cat | wc -c)
+expect=$(wc -c < "$TEST_DIR/big_file")
+(( actual == expect )) || log_error "cat through a pipe failed" "$expect" "$actual"
+mkfifo "$TEST_DIR/fifo"
+cat "$TEST_DIR/big_file" > "$TEST_DIR/fifo" &
+cat "$TEST_DIR/fifo" > "$TEST_DIR/copy_file"
+wait
+cmp -s "$TEST_DIR/big_file" "$TEST_DIR/copy_file" || log_error "cat of a fifo to a file differs"
+if [[ -r /proc/self/status ]]
+then
+    cat /proc/self/status > "$TEST_DIR/copy_file"
+    [[ -s $TEST_DIR/copy_file ]] || log_error "cat of a file that claims to be empty lost its contents"
+fi
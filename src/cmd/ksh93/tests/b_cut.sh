@@ -103,4 +103,28 @@ actual=$(cut -c -xyz "$TEST_DIR/foo" 2>&1)
 expect=$'cut: bad list for c/f option'
 [[ "$actual" =~ "$expect" ]] || log_error "'cut -b1 f1' should show an error" "$expect" "$actual"
 
+# ==========
+# Fields are found a line at a time, with the delimiter kept between ranges and a new-line
+# after a line that ends before the last range.
+print -n $'a\tb\tc\td\n\n1\t2\nnone\n\tx\ty\nlast\tline' > "$TEST_DIR/fields"
+actual=$(cut -f1,3 "$TEST_DIR/fields" | od -An -c)
+expect=$(print -n $'a\tc\n\n1\nnone\n\ty\nlast' | od -An -c)
+[[ "$actual" = "$expect" ]] || log_error "'cut -f1,3' failed" "$expect" "$actual"
+
+actual=$(cut -s -f2- "$TEST_DIR/fields" | od -An -c)
+expect=$(print -n $'b\tc\td\n2\nx\ty\nline' | od -An -c)
+[[ "$actual" = "$expect" ]] || log_error "'cut -s -f2-' failed" "$expect" "$actual"
+
+actual=$(cat "$TEST_DIR/fields" | cut -f-2,4 | od -An -c)
+expect=$(print -n $'a\tb\td\n\n1\t2\nnone\n\tx\nlast\tline' | od -An -c)
+[[ "$actual" = "$expect" ]] || log_error "'cut -f-2,4' from a pipe failed" "$expect" "$actual"
+
+# Lines longer than the input buffer.
+x=$(printf '%070000d' 0)
+print -r -- "$x:1:$x:2" > "$TEST_DIR/long"
+print -r -- "3$x" >> "$TEST_DIR/long"
+actual=$(cut -d: -f2,4 "$TEST_DIR/long")
+expect=$'1:2\n'3$x
+[[ "$actual" = "$expect" ]] || log_error "'cut' of long lines failed" "$expect" "$actual"
+
 # TODO: Add tests for multibyte characters
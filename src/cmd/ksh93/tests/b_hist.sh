@@ -0,0 +1,24 @@
+# Tests for hist builtin
+# The interactive tests are in b_hist.exp.
+
+# A history file larger than the part read at startup, so that the shell has to find the command
+# number markers written near its end.
+histfile=$TEST_DIR/history
+for ((i = 0; i < 800; i++))
+do  print ": command $(printf %04d $i) with a few more words"
+done > $TEST_DIR/commands
+HISTFILE=$histfile ENV=/dev/null $SHELL -i < $TEST_DIR/commands > /dev/null 2>&1
+(( $(wc -c < $histfile) > 20000 )) || log_error "history file is too small for the test"
+
+actual=$(HISTFILE=$histfile ENV=/dev/null $SHELL -i <<< 'hist -l -2' 2>/dev/null | sed 's/^\([0-9]*\) */\1 /')
+expect=$'799 : command 0798 with a few more words\n800 : command 0799 with a few more words\n801 hist -l -2'
+[[ $actual == "$expect" ]] || log_error "hist -l should number the commands of a large history file" "$expect" "$actual"
+
+# Commands are looked up by the string they begin with.
+actual=$(HISTFILE=$histfile ENV=/dev/null $SHELL -i <<< "hist -l ': command 0500' ': command 0502'" 2>/dev/null |
+    sed 's/^\([0-9]*\) */\1 /')
+expect=$'501 : command 0500 with a few more words\n502 : command 0501 with a few more words\n503 : command 0502 with a few more words'
+[[ $actual == "$expect" ]] || log_error "hist -l should find commands by their first characters" "$expect" "$actual"
+
+actual=$(HISTFILE=$histfile ENV=/dev/null $SHELL -i <<< "hist -l ': command 9999'" 2>&1)
+[[ $actual == *'not found'* ]] || log_error "hist -l should not find a string that is not in the history" "not found" "$actual"
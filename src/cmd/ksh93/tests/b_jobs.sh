@@ -61,3 +61,85 @@ actual="${ fg %99 2>&1; }"
 expect=""
 [[ "$actual" == "$expect" ]] ||
     log_error "fg invalid job with job monitoring disabled" "$expect" "$actual"
+
+# ======
+# The exit status of every background job is saved for wait, and job numbers are reused, when
+# more jobs are started than JOBMAX allows to run at once.
+JOBMAX=16
+unset pids
+typeset -a pids
+for ((i=0; i < 500; i++))
+do
+    { exit $((i % 7)); } &
+    pids[i]=$!
+done
+for ((i=0; i < 500; i+=37))
+do
+    wait ${pids[i]}
+    actual=$?
+    (( actual == i % 7 )) || log_error "wait for background job $i after JOBMAX" "$((i % 7))" "$actual"
+done
+wait
+unset JOBMAX
+actual="${ fg %1000000 2>&1; }"
+expect=""
+[[ "$actual" == "$expect" ]] ||
+    log_error "fg job number larger than the job table" "$expect" "$actual"
+
+# ======
+# wait -n returns as each job completes, in the order they complete, and wait -p names it.
+{ sleep .3; exit 3; } &
+pid1=$!
+{ sleep .1; exit 5; } &
+pid2=$!
+wait -n -p pid
+actual="$? $pid"
+expect="5 $pid2"
+[[ $actual == "$expect" ]] || log_error "wait -n did not return the first job to complete" "$expect" "$actual"
+wait -n -p pid
+actual="$? $pid"
+expect="3 $pid1"
+[[ $actual == "$expect" ]] || log_error "wait -n did not return the second job to complete" "$expect" "$actual"
+wait -n -p pid
+actual="$? ${pid-unset}"
+expect="127 unset"
+[[ $actual == "$expect" ]] || log_error "wait -n with no jobs left" "$expect" "$actual"
+
+{ exit 2; } &
+pid1=$!
+sleep .1
+{ exit 4; } &
+pid2=$!
+sleep .1
+wait $pid2
+wait -n -p pid
+actual="$? $pid"
+expect="2 $pid1"
+[[ $actual == "$expect" ]] || log_error "wait -n did not return a job that had already completed" "$expect" "$actual"
+wait -n
+actual=$?
+expect=127
+[[ $actual == "$expect" ]] || log_error "wait -n returned a job already waited for" "$expect" "$actual"
+
+{ sleep .1; exit 1; } &
+pid1=$!
+{ sleep .2; exit 9; } &
+pid2=$!
+wait -n -p pid $pid2
+actual="$? $pid"
+expect="9 $pid2"
+[[ $actual == "$expect" ]] || log_error "wait -n did not wait for the job operand" "$expect" "$actual"
+wait -p pid $pid1
+actual="$? $pid"
+expect="1 $pid1"
+[[ $actual == "$expect" ]] || log_error "wait -p without -n" "$expect" "$actual"
+
+{ exit 6; } &
+sleep .1
+actual=$(wait -n; print $?)
+expect=127
+[[ $actual == "$expect" ]] || log_error "wait -n in a subshell returned a job of the parent" "$expect" "$actual"
+wait -n
+actual=$?
+expect=6
+[[ $actual == "$expect" ]] || log_error "wait -n after a subshell" "$expect" "$actual"
@@ -0,0 +1,94 @@
+# Tests for mapfile builtin
+printf 'a\nb b\n\nc' > $TEST_DIR/lines
+
+mapfile < $TEST_DIR/lines
+expect=$'a\n|b b\n|\n|c'
+actual=$(IFS='|'; print -r -- "${MAPFILE[*]}")
+[[ $actual == "$expect" ]] || log_error "mapfile should store each line in MAPFILE" "$expect" "$actual"
+
+# -t Remove the delimiter from the end of each line.
+mapfile -t foo < $TEST_DIR/lines
+expect="typeset -a foo=(a 'b b' '' c)"
+actual=$(typeset -p foo)
+[[ $actual == "$expect" ]] || log_error "mapfile -t should strip new-lines" "$expect" "$actual"
+
+# readarray is an alias for mapfile.
+readarray -t bar < $TEST_DIR/lines
+[[ $(typeset -p bar) == "typeset -a bar=(a 'b b' '' c)" ]] || log_error "readarray is not mapfile"
+
+# -s count Discard the first count lines. -n count Store at most count lines.
+mapfile -t -s 1 -n 2 foo < $TEST_DIR/lines
+expect="typeset -a foo=('b b' '')"
+actual=$(typeset -p foo)
+[[ $actual == "$expect" ]] || log_error "mapfile -s 1 -n 2 failed" "$expect" "$actual"
+
+# -O origin Start at index origin and do not unset the array first.
+foo=(q r s t u)
+mapfile -t -O 3 foo < $TEST_DIR/lines
+expect="typeset -a foo=(q r s a 'b b' '' c)"
+actual=$(typeset -p foo)
+[[ $actual == "$expect" ]] || log_error "mapfile -O 3 failed" "$expect" "$actual"
+
+# -d delim Use delim instead of new-line, the empty string for a null byte.
+mapfile -t -d : foo <<< 'x:y:z'
+expect=$'typeset -a foo=(x y $\'z\\n\')'
+actual=$(typeset -p foo)
+[[ $actual == "$expect" ]] || log_error "mapfile -d : failed" "$expect" "$actual"
+printf 'x\0y\0' | mapfile -t -d '' foo
+expect="typeset -a foo=(x y)"
+actual=$(typeset -p foo)
+[[ $actual == "$expect" ]] || log_error "mapfile -d '' failed" "$expect" "$actual"
+
+# -u fd Read from file descriptor fd.
+mapfile -t -u 5 foo 5< $TEST_DIR/lines
+[[ ${#foo[@]} == 4 && ${foo[3]} == c ]] || log_error "mapfile -u 5 failed"
+mapfile -u 6 foo 6<&- 2> /dev/null && log_error "mapfile -u should fail for a closed file descriptor"
+
+# An empty file leaves an empty array.
+foo=(x y)
+mapfile foo < /dev/null
+[[ ${#foo[@]} == 0 ]] || log_error "mapfile of an empty file should leave no elements"
+
+# Lines after the last one stored are left for the next reader.
+{
+    mapfile -t -n 1 foo
+    read -r bar
+} < $TEST_DIR/lines
+[[ ${foo[0]} == a && $bar == 'b b' ]] || log_error "mapfile -n 1 read too much from a file"
+actual=$(printf '1\n2\n3\n' | { mapfile -t -n 1 foo; cat; })
+[[ $actual == $'2\n3' ]] || log_error "mapfile -n 1 read too much from a pipe" $'2\n3' "$actual"
+
+# Large inputs span many buffers and lines longer than a buffer are reassembled.
+seq 1 100000 > $TEST_DIR/seq
+mapfile -t foo < $TEST_DIR/seq
+[[ ${#foo[@]} == 100000 && ${foo[0]} == 1 && ${foo[99999]} == 100000 ]] ||
+    log_error "mapfile of 100000 lines failed" "100000 1 100000" "${#foo[@]} ${foo[0]} ${foo[99999]}"
+long=$(printf '%0200000d' 0)
+print -r -- "$long" | mapfile -t foo
+[[ ${#foo[@]} == 1 && ${foo[0]} == "$long" ]] || log_error "mapfile of a 200000 byte line failed"
+
+# Attributes of an existing array apply to the stored elements.
+typeset -a -u upper=(x)
+mapfile -t -O 1 upper < $TEST_DIR/lines
+expect="typeset -a -u upper=(X A 'B B' '' C)"
+actual=$(typeset -p upper)
+[[ $actual == "$expect" ]] || log_error "mapfile does not honor attributes" "$expect" "$actual"
+
+# Assignments in a subshell do not change the parent.
+foo=(x y)
+(mapfile -t foo < $TEST_DIR/lines; [[ ${#foo[@]} == 4 ]] || log_error "mapfile in subshell failed")
+[[ $(typeset -p foo) == "typeset -a foo=(x y)" ]] || log_error "mapfile in subshell changed the parent"
+
+readonly ro=1
+mapfile ro < $TEST_DIR/lines 2> /dev/null && log_error "mapfile should fail for a readonly variable"
+mapfile foo bar 2> /dev/null && log_error "mapfile should fail with two variables"
+typeset -A assoc=([k]=v)
+mapfile -O 0 assoc < $TEST_DIR/lines 2> /dev/null &&
+    log_error "mapfile -O should fail for an associative array"
+
+# Sparse arrays keep their other elements.
+typeset -a sparse=([100000]=x)
+mapfile -t -O 200000 sparse < $TEST_DIR/lines
+expect="100000 200000 200001 200002 200003"
+actual=${!sparse[*]}
+[[ $actual == "$expect" ]] || log_error "mapfile -O into a sparse array failed" "$expect" "$actual"
@@ -316,3 +316,28 @@ n=$(printf "%b" 'a\0b\0c' | wc -c)
 (( n == 5 )) || log_error '\0 not working with %b format with printf'
 
 [[ $($SHELL -c '{ printf %R "["; print ok;}' 2> /dev/null) == ok ]] || log_error $'\'printf %R "["\' causes shell to abort'
+
+# Formats are kept with their escapes expanded. Using more of them than are kept, and using one
+# again after others have replaced it, must give the same output each time.
+expect='0 a|1 a|2 a|3 a|4 a|5 a|6 a|7 a|8 a|9 a|10 a|11 a|0 b|'
+actual=$(for f in 0 1 2 3 4 5 6 7 8 9 10 11; do printf "$f %s|" a; done; printf '0 %s|' b)
+[[ $actual == "$expect" ]] || log_error 'printf with many formats failed' "$expect" "$actual"
+actual=$(printf 'x\ty\n' a b c)
+[[ $actual == $'x\ty' ]] || log_error 'printf without conversions prints extra output' $'x\ty' "$actual"
+actual=$(printf 'a%%b\n'; printf '\045d\n' 3)
+[[ $actual == $'a%b\n%d' ]] || log_error 'printf %% in a format without conversions failed' $'a%b\n%d' "$actual"
+actual=$(printf -- '-%s-\n' x)
+[[ $actual == -x- ]] || log_error 'printf -- with a format beginning with - failed' -x- "$actual"
+actual=$(printf '+%d\n' 5)
+[[ $actual == +5 ]] || log_error 'printf with a format beginning with + failed' +5 "$actual"
+
+# A format is cut into its text and conversions, which are done one at a time while arguments are
+# left. The text after the last conversion is written once per use of the format.
+actual=$(printf '<%s=%*d>\n' a 3 1 b 4 2)
+[[ $actual == $'<a=  1>\n<b=   2>' ]] || log_error 'printf reusing a format with * failed' $'<a=  1>\n<b=   2>' "$actual"
+actual=$(printf '[%s|%b]' x y z 'w\cv' u)
+[[ $actual == '[x|y][z|w' ]] || log_error 'printf \c in a reused format failed' '[z|w' "$actual"
+actual=$(printf '%s %n|\n' abc n; print $n)
+[[ $actual == $'abc |\n4' ]] || log_error 'printf %n failed' $'abc |\n4' "$actual"
+actual=$(printf '%2$s %1$s\n' a b)
+[[ $actual == 'b a' ]] || log_error 'printf with positional arguments failed' 'b a' "$actual"
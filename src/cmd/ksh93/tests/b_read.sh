@@ -154,6 +154,22 @@ then
     log_error "read -t in pipe taking $total_t secs - $(( reps * delay )) minimum - too fast"
 fi
 
+# Thousands of timeouts that are set and cancelled must not keep a later one from firing on time.
+for (( i=0 ; i < 5000 ; i++ ))
+do
+    read -t $(( 100 + i % 97 )) x <<< $i
+done
+[[ $x == 4999 ]] || log_error "read -t of a here-string failed" 4999 "$x"
+sleep 2 | {
+    start_x=SECONDS
+    read -t 0.2 x
+    actual=$?
+    (( total_t = SECONDS - start_x ))
+    [[ $actual == 1 ]] || log_error "read -t after many timeouts did not time out" 1 "$actual"
+    (( total_t >= 0.2 && total_t < 1.5 )) ||
+        log_error "read -t 0.2 after many timeouts took $total_t secs"
+}
+
 print "one\ntwo" | { read line
     print $line | /bin/cat > /dev/null
     read line
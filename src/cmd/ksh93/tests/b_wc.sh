@@ -68,3 +68,42 @@ expect=$"      33 $TEST_DIR/file2"
 actual=$(wc -N "$TEST_DIR/file2")
 expect="       7      38     158 $TEST_DIR/file2"
 [[ "$actual" = "$expect" ]] || log_error "'wc -N' failed" "$expect" "$actual"
+
+# ==========
+# Files big enough to be read in several buffers, with every kind of blank, words that straddle
+# the buffers and, in the second file, a multibyte character now and then.
+integer i
+for (( i = 0; i < 20000; i++ ))
+do  print -r -- $'a\tbb\vccc\fdddd\re  f'
+done > "$TEST_DIR/big_ascii"
+print -n "tail" >> "$TEST_DIR/big_ascii"
+for (( i = 0; i < 20000; i++ ))
+do  if (( i % 1000 == 999 ))
+    then print -r -- "word é mot"
+    else print -r -- "word and mot"
+    fi
+done > "$TEST_DIR/big_mixed"
+
+actual=$(wc < "$TEST_DIR/big_ascii")
+expect="   20000  120001  380004"
+[[ "$actual" = "$expect" ]] || log_error "'wc' of a large file failed" "$expect" "$actual"
+actual=$(wc -l < "$TEST_DIR/big_ascii")
+expect="   20000"
+[[ "$actual" = "$expect" ]] || log_error "'wc -l' of a large file failed" "$expect" "$actual"
+actual=$(LC_ALL=C wc -w < "$TEST_DIR/big_ascii")
+expect="  120001"
+[[ "$actual" = "$expect" ]] || log_error "'wc -w' of a large file in the C locale failed" "$expect" "$actual"
+actual=$(cat "$TEST_DIR/big_ascii" | wc -lw)
+expect="   20000  120001"
+[[ "$actual" = "$expect" ]] || log_error "'wc -lw' of a large pipe failed" "$expect" "$actual"
+x=é
+if (( ${#x} == 1 ))
+then
+    actual=$(wc -lwm < "$TEST_DIR/big_mixed")
+    expect="   20000   60000  259960"
+    [[ "$actual" = "$expect" ]] ||
+        log_error "'wc -lwm' of a large file with multibyte characters failed" "$expect" "$actual"
+fi
+actual=$(wc -c < "$TEST_DIR/big_mixed")
+expect="  259980"
+[[ "$actual" = "$expect" ]] || log_error "'wc -c' of a large file with multibyte characters failed" "$expect" "$actual"
@@ -763,3 +763,29 @@ done)
 
 expect=$'foo\nbar\nbaz'
 [[ "$actual" = "$expect" ]] || log_error "for loop without 'in' should loop over '\$@'" "$expect" "$actual" "$actual" "$actual" 
+
+# The parse tree of a `...` command substitution in a loop is reused; make sure that only
+# happens while it would have parsed the same way.
+actual=$($SHELL -c '
+    alias foo="print one"
+    for i in 1 2 3
+    do
+        print -n `foo $i` ""
+        alias foo="print two"
+    done
+    for i in 1 2
+    do
+        print -n `(alias foo="print sub"); foo $i` ""
+        print -n `eval "f$i() { print f$i; }"; f$i` ""
+        print -n `f() { print g$i; }; f` ""
+        print -n `cat <<!
+here $i
+!
+` ""
+        print -n `print $LINENO` ""
+        (x=`for`) 2> /dev/null || print -n "err "
+    done
+    (( .sh.stats.comsub_cachehits > 0 )) || print "no cache hits"
+' 2>&1)
+expect="one 1 two 2 two 3 two 1 f1 g1 here 1 17 err two 2 f2 g2 here 2 17 err "
+[[ $actual == "$expect" ]] || log_error 'cached `...` parse trees changed the results' "$expect" "$actual"
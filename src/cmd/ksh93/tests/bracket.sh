@@ -476,3 +476,28 @@ $SHELL -c 2> /dev/null '[[ AATAATCCCAATAAT =~ (AAT){2}CCC(AAT){2} ]]' || log_err
 x=10
 
 ([[ x -eq 10 ]]) 2> /dev/null || log_error 'x -eq 10 fails in [[...]] with x=10'
+
+# The status of a file shared by the operators of one [[...]] must not outlive a change to the file
+# made while the expression is evaluated, or the expression itself.
+file=$TEST_DIR/statmemo
+print x > $file
+[[ -e $file && -s $file && $(: > $file) == "" && ! -s $file ]] ||
+    log_error '[[...]] file operators did not see a change made by a command substitution'
+[[ -f $file && $(rm $file) == "" && ! -e $file && ! -f $file ]] ||
+    log_error '[[...]] file operators did not see a file removed by a command substitution'
+i=0
+while [[ ! -e $file ]]
+do
+    (( i++ == 3 )) && print > $file
+done
+(( i == 4 )) || log_error '[[ ! -e file ]] in a loop did not see the file created by the loop' 4 "$i"
+function f.get { rm -f $file; }
+[[ -e $file && -z $f && ! -e $file ]] ||
+    log_error '[[...]] file operators did not see a change made by a get discipline'
+unset -f f.get
+print x > $file
+exec 4< $file
+[[ -e /dev/fd/4 && -f /dev/fd/4 && -s /dev/fd/4 ]] || log_error '[[ -f /dev/fd/4 && -s /dev/fd/4 ]] failed'
+exec 4<&-
+[[ -f /dev/fd/4 ]] && log_error '[[ -f /dev/fd/4 ]] is true after fd 4 is closed'
+test -f $file -a -s $file -a ! -d $file || log_error 'test -f file -a -s file -a ! -d file failed'
@@ -667,3 +667,23 @@ expect="umask: foo: bad format"
 actual=$(logname)
 expect=$(command logname)
 [[ "$actual" = "$expect" ]] || log_error "logname failed" "$expect" "$actual"
+
+# ==========
+# A library named by PLUGIN_LIB in .paths is asked for each b_* symbol only once, whether it has
+# that builtin or not.
+mkdir -p $TEST_DIR/plugin/bin
+print "PLUGIN_LIB=$LIBSAMPLE_PATH" > $TEST_DIR/plugin/bin/.paths
+print 'print external' > $TEST_DIR/plugin/bin/sample
+chmod +x $TEST_DIR/plugin/bin/sample
+actual=$(PATH=$TEST_DIR/plugin/bin:$PATH $SHELL -c '
+    sample > /dev/null
+    hash -r
+    for i in 1 2 3 4 5 6
+    do
+        nosuch_$((i % 2)) 2> /dev/null
+    done
+    print ${.sh.stats.bltin_cachehits} ${.sh.stats.bltin_cachemisses}
+    print -r -- "$(sample)"
+    whence -v sample')
+expect=$'4 2\nThis is a sample builtin\nsample is a shell builtin version of '"$TEST_DIR/plugin/bin/sample"
+[[ "$actual" == "$expect" ]] || log_error "plugin library symbol lookups not cached" "$expect" "$actual"
@@ -90,3 +90,41 @@ case "[0-9]" in
     "[0-9]") ;;
     *) log_error "Shell fails to match quoted pattern-like string as literal string";;
 esac
+
+# A case with more glob arms than the old 8 entry pattern cache must not recompile them each time.
+actual=$($SHELL -c '
+    for ((i = 0; i < 50; i++))
+    do  case x$i.z in
+        a?[1]) ;; a?[2]) ;; a?[3]) ;; a?[4]) ;; a?[5]) ;; a?[6]) ;; a?[7]) ;; a?[8]) ;;
+        b?[1]) ;; b?[2]) ;; b?[3]) ;; b?[4]) ;; b?[5]) ;; b?[6]) ;; b?[7]) ;; b?[8]) ;;
+        a?[9]) ;; a?[0]) ;; b?[9]) ;; b?[0]) ;;
+        x?*.z) n=$((n + 1)) ;;
+        esac
+    done
+    print $n $(( .sh.stats.regex_cachemisses < 50 )) $(( .sh.stats.regex_cachehits >= 1000 ))
+    ')
+expect="50 1 1"
+[[ $actual == $expect ]] || log_error "case glob arms not cached" "$expect" "$actual"
+
+# Cases with enough patterns are indexed; the first matching arm must still win, patterns that need
+# expansion must be expanded in order up to the matching arm, and ;& must fall through.
+function dispatch {
+    case $1 in
+    start|begin) print -n S ;;
+    stop) print -n T ;;
+    *.c|*.h) print -n C ;&
+    x*y) print -n X ;;
+    $(print -n E >&2; print dyn)) print -n D ;;
+    "lit"*) print -n L ;;
+    [0-9]*) print -n N ;;
+    stop|dyn) print -n T2 ;;
+    '*q') print -n Q ;;
+    *) print -n F ;;
+    esac
+}
+actual=$(for w in start begin stop a.c b.h xay xy dyn litx 9z '*q' zq '' $'\xff.c'; do dispatch "$w"; print -n ,; done 2>&1)
+expect="S,S,T,CX,CX,X,X,ED,EL,EN,EQ,EF,EF,CX,"
+[[ $actual == "$expect" ]] || log_error "indexed case dispatch" "$expect" "$actual"
+actual=$(LC_ALL=C.UTF-8; for w in a.c é.c é; do dispatch "$w"; print -n ,; done 2>&1)
+expect="CX,CX,EF,"
+[[ $actual == "$expect" ]] || log_error "indexed case dispatch in a UTF-8 locale" "$expect" "$actual"
@@ -1335,3 +1335,53 @@ $SHELL -c 'function ftest { ftest2; }; function ftest2 { unset -f ftest; }; ftes
 function f2 { env | grep -q "^foo" || log_error "Environment variable is not propogated from caller function"; }
 function f1 { f2; env | grep -q "^foo" || log_error "Environment variable is not passed to a function"; }
 foo=bar f1
+
+# Functions autoloaded with FPATH_CACHE set are read from the cache once it has been written and
+# must behave the same as when they are parsed.
+mkdir -p $TEST_DIR/fpcache/fun $TEST_DIR/fpcache/cache
+cat > $TEST_DIR/fpcache/fun/cachefn <<'EOF2'
+function cachefn {
+    print "cachefn $*"
+    cachehelper
+}
+cachehelper() { print helper; }
+EOF2
+cat > $TEST_DIR/fpcache/fun/cachebad <<'EOF2'
+function cachebad { print ( ; }
+EOF2
+touch -t 200001010000 $TEST_DIR/fpcache/fun/cachefn $TEST_DIR/fpcache/fun/cachebad
+cachetest='cachefn a b; typeset -f cachefn; print ${.sh.stats.fpath_cachehits}'
+expect=$($SHELL -c "FPATH=$TEST_DIR/fpcache/fun; $cachetest")
+[[ $expect == *'print "cachefn $*"'*0 ]] || log_error 'autoloaded function is wrong' "" "$expect"
+export FPATH_CACHE=$TEST_DIR/fpcache/cache
+actual=$($SHELL -c "FPATH=$TEST_DIR/fpcache/fun; $cachetest")
+[[ $actual == "$expect" ]] || log_error 'function that is cached is wrong' "$expect" "$actual"
+actual=$($SHELL -c "FPATH=$TEST_DIR/fpcache/fun; $cachetest")
+[[ $actual == "${expect%0}1" ]] || log_error 'function read from cache is wrong' "${expect%0}1" "$actual"
+print 'function cachefn { print changed; }' > $TEST_DIR/fpcache/fun/cachefn
+touch -t 200001010000 $TEST_DIR/fpcache/fun/cachefn
+actual=$($SHELL -c "FPATH=$TEST_DIR/fpcache/fun; cachefn; print \${.sh.stats.fpath_cachehits}")
+expect=$'changed\n0'
+[[ $actual == "$expect" ]] || log_error 'changed function file read from cache' "$expect" "$actual"
+for i in 1 2
+do
+    actual=$($SHELL -c "FPATH=$TEST_DIR/fpcache/fun; cachebad" 2>&1)
+    [[ $actual == *'syntax error'* ]] ||
+        log_error 'syntax error in cached function file not reported' "syntax error" "$actual"
+done
+unset FPATH_CACHE
+
+# Functions added to an FPATH directory after its names have been read must be found.
+mkdir -p $TEST_DIR/fpindex
+touch -t 200001010000 $TEST_DIR/fpindex
+actual=$($SHELL -c '
+    FPATH=$1
+    for i in 1 2 3 4 5
+    do
+        nosuchfn$i 2> /dev/null
+    done
+    print "function newfn { print new function; }" > $1/newfn
+    newfn
+' fpindex $TEST_DIR/fpindex 2>&1)
+expect="new function"
+[[ $actual == "$expect" ]] || log_error 'function added to an indexed FPATH directory not found' "$expect" "$actual"
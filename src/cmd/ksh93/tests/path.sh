@@ -430,3 +430,40 @@ cat < /dev/null || log_error "Directories should not be treated as executables"
 
 # Restore PATH
 PATH="$OPATH"
+
+# Commands added to a PATH directory after its names have been read must be found.
+mkdir -p $TEST_DIR/cachebin
+touch -t 200001010000 $TEST_DIR/cachebin
+actual=$($SHELL -c '
+    PATH=$1:/bin:/usr/bin
+    for i in 1 2 3 4 5
+    do
+        nosuchcmd$i 2> /dev/null
+    done
+    (( .sh.stats.path_cachehits > 0 )) || print "no cache hits"
+    print "print new command" > $1/newcmd
+    chmod +x $1/newcmd
+    newcmd
+' cachetest $TEST_DIR/cachebin 2>&1)
+expect="new command"
+[[ $actual == "$expect" ]] || log_error 'command added to a cached PATH directory not found' "$expect" "$actual"
+
+# Commands in a PATH directory that can be searched but not read must still be found, and the
+# names of a directory that cannot be read are not cached.
+mkdir -p $TEST_DIR/execbin
+print 'print found' > $TEST_DIR/execbin/execcmd
+chmod +x $TEST_DIR/execbin/execcmd
+chmod 111 $TEST_DIR/execbin
+actual=$($SHELL -c '
+    PATH=$1
+    for i in 1 2 3 4 5
+    do
+        nosuchcmd$i 2> /dev/null
+    done
+    execcmd
+    execcmd
+    [[ -r $1 ]] || (( .sh.stats.path_cachehits == 0 )) || print "cache hits in unreadable directory"
+' cachetest $TEST_DIR/execbin 2>&1)
+chmod 755 $TEST_DIR/execbin
+expect=$'found\nfound'
+[[ $actual == "$expect" ]] || log_error 'command in an execute-only PATH directory not found' "$expect" "$actual"
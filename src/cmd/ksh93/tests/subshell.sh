@@ -856,3 +856,46 @@ for exp in 65535 65536
 do    got=$($SHELL -c 'x=$(printf "%.*c" '$exp' x); print ${#x}' 2>&1)
     [[ $got == $exp ]] || log_error "large command substitution failed" "$exp" "$got"
 done
+
+# Command substitution output that has to be put in a real file for an external command should
+# not touch $TMPDIR where memfd_create() is available.
+if [[ $OS_NAME == linux ]]
+then
+    got=$(print x; readlink -f /dev/stdout)
+    [[ $got == x$'\n'/memfd:* ]] || log_error "command substitution should use a memory file" "x"$'\n'"/memfd:sftmp" "$got"
+fi
+exp=$(( 3 * 1024 * 1024 + 1 ))
+got=$(x=$(print -n a; head -c $(( exp - 1 )) /dev/zero | tr '\0' x); print ${#x})
+[[ $got == $exp ]] || log_error "multi-megabyte command substitution failed" "$exp" "$got"
+
+# Assigning elements of an indexed array in a subshell saves only those elements. They have to be
+# restored whatever else the subshell does to the array.
+typeset -a arr=(x0 x1 x2 '' x4)
+unset arr[3]
+got=$(arr[1]=y; arr[3]=new; arr[9]=far; unset arr[4]; arr[1]=z; print "${arr[@]}|${!arr[@]}")
+exp="x0 z x2 new far|0 1 2 3 9"
+[[ $got == "$exp" ]] || log_error "array elements not assigned in subshell" "$exp" "$got"
+exp="x0 x1 x2 x4|0 1 2 4"
+got="${arr[@]}|${!arr[@]}"
+[[ $got == "$exp" ]] || log_error "array elements not restored after subshell" "$exp" "$got"
+( arr[0]=q; unset arr; arr[2]=w )
+got="${arr[@]}|${!arr[@]}"
+[[ $got == "$exp" ]] || log_error "array not restored after element assignment and unset" "$exp" "$got"
+( arr[0]=q; typeset -u arr; arr[1]=lower; [[ ${arr[1]} == LOWER ]] )
+got="${arr[@]}|${!arr[@]}"
+[[ $got == "$exp" ]] || log_error "array not restored after element assignment and typeset -u" "$exp" "$got"
+( arr[0]=q; arr+=(m n); arr[1]=r )
+got="${arr[@]}|${!arr[@]}"
+[[ $got == "$exp" ]] || log_error "array not restored after element assignment and append" "$exp" "$got"
+( ( arr[0]=inner ); arr[0]=outer; ( arr[2]=deep ); [[ ${arr[0]}${arr[2]} == outerx2 ]] )
+got="${arr[@]}|${!arr[@]}"
+[[ $got == "$exp" ]] || log_error "array not restored after nested subshells" "$exp" "$got"
+arr[1]=after
+[[ ${arr[1]} == after ]] || log_error "array has subshell attributes after subshell" "after" "${arr[1]}"
+unset arr
+
+str=abc
+( typeset -u str )
+str=low
+[[ $str == low ]] || log_error "typeset -u in subshell should not apply after it" "low" "$str"
+unset str
@@ -0,0 +1,38 @@
+#
+# Time tight `for (( ... ))` loops doing integer arithmetic, and one doing floating point
+# arithmetic for comparison. Not part of `meson test`; run it with `meson test --benchmark arith`.
+# An optional argument is the number of iterations.
+#
+integer i s x n=${1:-1000000}
+typeset -F6 start elapsed y
+
+function report {
+    (( elapsed = SECONDS - start ))
+    printf '%-40s %.3f sec, %.3f usec per iteration\n' "$1" elapsed '1e6 * elapsed / n'
+    start=SECONDS
+}
+
+start=SECONDS
+for (( i = 0; i < n; i++ ))
+do
+    :
+done
+report 'for (( i = 0; i < n; i++ ))'
+
+for (( i = 0; i < n; i++ ))
+do
+    (( s = s + (i << 2) ^ (i >> 1) ))
+done
+report '(( s = s + (i << 2) ^ (i >> 1) ))'
+
+for (( i = 0; i < n; i++ ))
+do
+    x=$(( x + i / 3 ))
+done
+report 'x=$(( x + i / 3 ))'
+
+for (( i = 0; i < n; i++ ))
+do
+    (( y = 1.5 * i ))
+done
+report '(( y = 1.5 * i ))'
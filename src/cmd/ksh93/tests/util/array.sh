@@ -0,0 +1,43 @@
+#
+# Time filling indexed arrays that are dense, sparse and a mix of both, and report the largest
+# resident set size of the shell that did it where /proc shows it. Not part of `meson test`; run it
+# with `meson test --benchmark array`. An optional argument is the number of dense elements.
+#
+integer n=${1:-1000000}
+
+# Each workload runs in a shell of its own so the memory it reports is its own.
+function run {
+    "$SHELL" -c '
+        integer i n=$1
+        typeset -a a
+        typeset -F6 start=SECONDS elapsed
+        '"$2"'
+        (( elapsed = SECONDS - start ))
+        typeset rss=? line
+        if [[ -r /proc/$$/status ]]
+        then
+            while read -r line
+            do
+                [[ $line == VmHWM:* ]] && rss=$(( ${line//[!0-9]} / 1024 ))MB
+            done < /proc/$$/status
+        fi
+        printf "%-48s %8.3f sec %8s\n" "$0" elapsed "$rss"
+    ' "$1" "$n" "$2"
+}
+
+run 'dense    a[i]=$i, n elements' \
+    'for (( i = 0; i < n; i++ )); do a[i]=$i; done'
+run 'sparse   a[i*5000]=$i, n/50 elements' \
+    'for (( i = 0; i < n / 50; i++ )); do a[i*5000]=$i; done'
+run 'mixed    n/10 dense, 20 at strides of n' \
+    'for (( i = 0; i < n / 10; i++ )); do a[i]=$i; done
+     for (( i = 1; i <= 20; i++ )); do a[i*n]=$i; done'
+run 'random   n/20 subscripts below 2^30' \
+    'integer r=1
+     for (( i = 0; i < n / 20; i++ )); do (( r = (r * 1103515245 + 12345) & 0x3fffffff )); a[r]=$i; done'
+run 'list     a=( {1..n*3/10} )' \
+    'eval "a=( {1..$(( n * 3 / 10 ))} )"'
+run 'walk     ${!a[@]} of the sparse array, 10 times' \
+    'for (( i = 0; i < n / 50; i++ )); do a[i*5000]=$i; done
+     start=SECONDS
+     for (( i = 0; i < 10; i++ )); do for r in "${!a[@]}"; do :; done; done'
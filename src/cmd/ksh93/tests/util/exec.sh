@@ -0,0 +1,42 @@
+#
+# Time running an external command many times at the global scope, with the environment the shell
+# was started with and with 150 more exported variables, and report how often the environment list
+# generated for a command was reused. Not part of `meson test`; run it with
+# `meson test --benchmark exec`. An optional argument is the number of commands.
+#
+integer i n=${1:-100000} hits
+typeset -F6 start elapsed
+
+function report {
+    (( elapsed = SECONDS - start ))
+    printf '%-56s %8.3f sec %8d reused\n' "$1" elapsed $(( ${.sh.stats.env_cachehits} - hits ))
+    hits=${.sh.stats.env_cachehits}
+    start=SECONDS
+}
+
+hits=${.sh.stats.env_cachehits}
+start=SECONDS
+for (( i = 0; i < n; i++ ))
+do
+    /bin/true
+done
+report "$n /bin/true"
+
+for (( i = 0; i < 150; i++ ))
+do
+    export EXEC_BENCH_$i=$i
+done
+start=SECONDS
+for (( i = 0; i < n; i++ ))
+do
+    /bin/true
+done
+report "$n /bin/true, 150 more exported variables"
+
+start=SECONDS
+for (( i = 0; i < n; i++ ))
+do
+    EXEC_BENCH_0=$i
+    /bin/true
+done
+report "$n /bin/true, an exported variable assigned each time"
@@ -0,0 +1,53 @@
+#
+# Time the file operators of `[[ ... ]]` and `test` over a directory of files, the way a tree walk
+# in a script uses them. Not part of `meson test`; run it with `meson test --benchmark filetest`.
+# An optional argument is the number of files to create.
+#
+integer i n=0 nfiles=${1:-100000}
+typeset -F6 start elapsed
+typeset dir f
+
+dir=$(mktemp -d "${TMPDIR:-/tmp}/filetest.XXXXXX") || exit
+trap 'rm -rf "$dir"' EXIT
+for (( i = 0; i < nfiles; i++ ))
+do
+    if (( i & 1 ))
+    then
+        print $i > $dir/f$i
+    else
+        : > $dir/f$i
+    fi
+done
+
+function report {
+    (( elapsed = SECONDS - start ))
+    printf '%-40s %.3f sec, %.2f usec per file (%d matched)\n' "$1" elapsed \
+        '1e6 * elapsed / nfiles' n
+    n=0
+    start=SECONDS
+}
+
+start=SECONDS
+for f in $dir/*
+do
+    [[ -e $f && -f $f && -r $f && -s $f ]] && (( n++ ))
+done
+report '[[ -e && -f && -r && -s ]]'
+
+for f in $dir/*
+do
+    [[ $f -nt $dir/f0 || $f -ot $dir/f0 ]] && (( n++ ))
+done
+report '[[ -nt || -ot ]]'
+
+for f in $dir/*
+do
+    [[ -f $f && ! -L $f && -s $f && -O $f ]] && (( n++ ))
+done
+report '[[ -f && ! -L && -s && -O ]]'
+
+for f in $dir/*
+do
+    test -f $f -a -s $f && (( n++ ))
+done
+report 'test -f -a -s'
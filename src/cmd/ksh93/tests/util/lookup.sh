@@ -0,0 +1,85 @@
+#
+# Time name lookups: a script that reads and assigns many global variables from a function, and
+# associative arrays filled and read with scattered keys, with keys in order, and read while their
+# subscripts are walked. The time for an associative array includes unsetting it. Not part of
+# `meson test`; run it with `meson test --benchmark lookup`. An optional argument is the number of
+# associative array keys.
+#
+integer i j n=${1:-1000000} nvars=2000
+typeset -F6 start elapsed
+typeset k s
+
+function report {
+    (( elapsed = SECONDS - start ))
+    printf '%-52s %.3f sec\n' "$1" elapsed
+    start=SECONDS
+}
+
+start=SECONDS
+for (( i = 0; i < nvars; i++ ))
+do
+    eval "v$i=$i"
+done
+function sum {
+    integer i j t=0
+    for (( j = 0; j < 50; j++ ))
+    do
+        for (( i = 0; i < nvars; i += 7 ))
+        do
+            nameref r=v$i
+            (( t += r ))
+        done
+        (( t += v1 + v100 + v1000 + v1999 ))
+        s=$v17$v170$v1700
+    done
+    print -r -- $t
+}
+for (( i = 0; i < 20; i++ ))
+do
+    sum > /dev/null
+done
+report "$nvars globals read from a function"
+
+typeset -A a
+for (( i = 0; i < n; i++ ))
+do
+    a[$(( (i * 7919) % n ))]=$i
+done
+for (( i = 0; i < n; i++ ))
+do
+    s=${a[$(( (i * 104729) % n ))]}
+done
+report "$n keys, scattered insert and lookup"
+for k in "${!a[@]}"
+do
+    break
+done
+unset a
+report "the same keys, start of a walk and unset"
+
+typeset -A a
+for (( i = 0; i < n; i++ ))
+do
+    a[k$i]=$i
+done
+for (( i = 0; i < n; i++ ))
+do
+    s=${a[k$i]}
+done
+unset a
+report "$n keys k0,k1,... in order, insert and lookup"
+
+typeset -A a
+for (( i = 0; i < n / 10; i++ ))
+do
+    a[k$i]=$i
+done
+for (( j = 0; j < 10; j++ ))
+do
+    for k in "${!a[@]}"
+    do
+        s=${a[$k]}
+    done
+done
+unset a
+report "$(( n / 10 )) keys, 10 walks reading each element"
@@ -0,0 +1,41 @@
+#
+# Time printf writing a report a line at a time, and with one call that reuses its format for all
+# the lines. Not part of `meson test`; run it with `meson test --benchmark printf`. An optional
+# argument is the number of lines.
+#
+integer i nlines=${1:-1000000}
+typeset -F6 start elapsed
+typeset -a values
+
+function report {
+    (( elapsed = SECONDS - start ))
+    printf '%-40s %.3f sec, %.2f usec per line\n' "$1" elapsed '1e6 * elapsed / nlines'
+    start=SECONDS
+}
+
+start=SECONDS
+for (( i = 0; i < nlines; i++ ))
+do
+    printf 'line\n'
+done > /dev/null
+report "printf 'line\n'"
+
+for (( i = 0; i < nlines; i++ ))
+do
+    printf '%-8s %6d %08x\n' item $i $i
+done > /dev/null
+report "printf '%-8s %6d %08x\n' per line"
+
+for (( i = 0; i < nlines; i++ ))
+do
+    printf '%s\t%s\n' key value
+done > /dev/null
+report "printf '%s\t%s\n' per line"
+
+for (( i = 0; i < nlines; i++ ))
+do
+    values[i]=$i
+done
+start=SECONDS
+printf '%s\t%5d\n' "${values[@]}" "${values[@]}" > /dev/null
+report "printf '%s\t%5d\n' reused"
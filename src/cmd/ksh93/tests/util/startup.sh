@@ -0,0 +1,46 @@
+#
+# Time how long it takes to start the shell, run the null command and exit. This is what a shell
+# that is launched for every short hook pays. Not part of `meson test`; run it with
+# `meson test --benchmark startup`. An optional argument is the number of shells to start. When
+# perf(1) can count instructions they are reported too, since they vary much less than the times.
+#
+integer i reps=${1:-2000}
+typeset -F6 start elapsed user sys
+
+start=SECONDS
+for (( i = 0; i < reps; i++ ))
+do
+    "$SHELL" -c :
+done
+(( elapsed = SECONDS - start ))
+
+# The second line of `times` is the CPU time used by the shells that were started.
+function seconds {
+    typeset m=${1%%m*} s=${1#*m}
+    print -r -- $(( 60 * m + ${s%s} ))
+}
+set -A t $(times)
+user=$(seconds ${t[2]})
+sys=$(seconds ${t[3]})
+printf '%d shells, %.1f usec each (%.1f usec user, %.1f usec system)\n' \
+    reps '1e6 * elapsed / reps' '1e6 * user / reps' '1e6 * sys / reps'
+
+# Count the instructions of the same loop. `perf stat -x,` writes `count,unit,event,...` to stderr.
+# The count is not a number when the kernel does not provide the counter.
+if whence -q perf
+then
+    typeset count
+    count=$(perf stat -x, -e instructions -- "$SHELL" -c '
+        integer i
+        for (( i = 0; i < $1; i++ ))
+        do
+            "$SHELL" -c :
+        done' startup $reps 2>&1 >/dev/null)
+    count=${count%%,*}
+    if [[ $count == +([0-9]) ]]
+    then
+        printf '%.0f instructions each\n' 'count / reps'
+    else
+        print -r -- "perf cannot count instructions here"
+    fi
+fi
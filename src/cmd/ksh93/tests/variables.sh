@@ -831,3 +831,12 @@ actual="${.sh.file}"
 actual="$(pwd -f ${.sh.pwdfd})"
 expect="$PWD"
 [[ "$actual" = "$expect" ]] || log_error ".sh.pwdfd should point to fd of current working directory"
+
+# ==========
+# .sh.stats is made when it is first used, which may be in a subshell or by listing its members.
+set -A actual $($SHELL -c '(: ${.sh.stats.forks}); typeset -p .sh.stats')
+set -A expect $($SHELL -c 'typeset -p .sh.stats')
+(( ${#actual[@]} == ${#expect[@]} )) ||
+    log_error ".sh.stats members lost when it is made late" "${expect[*]}" "${actual[*]}"
+actual=$($SHELL -c 'integer n=0; for name in ${!.sh.stats@}; do ((n++)); done; print $n')
+(( actual > 20 )) || log_error "\${!.sh.stats@} should list all the counters" "> 20" "$actual"
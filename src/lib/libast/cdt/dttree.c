@@ -21,6 +21,7 @@
  ***********************************************************************/
 #include "config_ast.h"  // IWYU pragma: keep
 
+#include <limits.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -135,11 +136,93 @@ static_fn void *dttree_clear(Dt_t *dt) {
     return NULL;
 }
 
+/* merge two sorted lists, objects of the first list going first among equals */
+static_fn Dtlink_t *dttree_merge(Dt_t *dt, Dtlink_t *l1, Dtlink_t *l2) {
+    Dtlink_t head, *t = &head;
+    Dtdisc_t *disc = dt->disc;
+
+    while (l1 && l2) {
+        if (_DTCMP(dt, _DTKEY(disc, _DTOBJ(disc, l2)), _DTKEY(disc, _DTOBJ(disc, l1)), disc) < 0) {
+            t = t->_rght = l2;
+            l2 = l2->_rght;
+        } else {
+            t = t->_rght = l1;
+            l1 = l1->_rght;
+        }
+    }
+    t->_rght = l1 ? l1 : l2;
+    return head._rght;
+}
+
+/* sort a list coming from an unordered method so that restoring it does not
+** splay through the tree in random order
+*/
+static_fn Dtlink_t *dttree_sort(Dt_t *dt, Dtlink_t *list) {
+    Dtlink_t *bin[sizeof(size_t) * CHAR_BIT], *r;
+    Dtdisc_t *disc = dt->disc;
+    int k, n;
+
+    for (r = list; r && r->_rght; r = r->_rght) {
+        if (_DTCMP(dt, _DTKEY(disc, _DTOBJ(disc, r)), _DTKEY(disc, _DTOBJ(disc, r->_rght)), disc) >
+            0) {
+            break;
+        }
+    }
+    if (!r || !r->_rght) return list; /* already sorted */
+
+    for (n = 0; (r = list);) { /* bin[k] holds a sorted run of 2^k objects */
+        list = r->_rght;
+        r->_rght = NULL;
+        for (k = 0; k < n && bin[k]; ++k) {
+            r = dttree_merge(dt, bin[k], r);
+            bin[k] = NULL;
+        }
+        if (k == n) n += 1;
+        bin[k] = r;
+    }
+    for (r = NULL, k = 0; k < n; ++k) {
+        if (bin[k]) r = dttree_merge(dt, bin[k], r);
+    }
+    return r;
+}
+
+/* count a list that is strictly ascending, 0 if it is not
+*/
+static_fn ssize_t dttree_ascending(Dt_t *dt, Dtlink_t *list) {
+    Dtlink_t *r;
+    Dtdisc_t *disc = dt->disc;
+    ssize_t n = 0;
+
+    for (r = list; r; r = r->_rght, ++n) {
+        if (r->_rght &&
+            _DTCMP(dt, _DTKEY(disc, _DTOBJ(disc, r)), _DTKEY(disc, _DTOBJ(disc, r->_rght)), disc) >=
+                0) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+/* make a balanced tree of the first n objects of an ascending list
+*/
+static_fn Dtlink_t *dttree_build(Dtlink_t **list, ssize_t n) {
+    Dtlink_t *root, *left;
+
+    if (n <= 0) return NULL;
+    left = dttree_build(list, (n - 1) / 2);
+    root = *list;
+    *list = root->_rght;
+    root->_left = left;
+    root->_rght = dttree_build(list, n - 1 - (n - 1) / 2);
+    return root;
+}
+
 static_fn void *dttree_list(Dt_t *dt, Dtlink_t *list, int type) {
     void *obj;
     Dtlink_t *last, *r, *t;
     Dttree_t *tree = (Dttree_t *)dt->data;
     Dtdisc_t *disc = dt->disc;
+    ssize_t n;
 
     if (type & (DT_FLATTEN | DT_EXTRACT)) {
         if ((list = tree->root)) {
@@ -163,6 +246,14 @@ static_fn void *dttree_list(Dt_t *dt, Dtlink_t *list, int type) {
     } else /* if(type&DT_RESTORE) */
     {
         dt->data->size = 0;
+        if (!tree->root && (n = dttree_ascending(dt, list)) > 0) {
+            /* an ascending list such as a table sorted at build time needs no searches */
+            r = list;
+            tree->root = dttree_build(&r, n);
+            dt->data->size = n;
+            return (void *)list;
+        }
+        list = dttree_sort(dt, list);
         for (r = list; r; r = t) {
             t = r->_rght;
             obj = _DTOBJ(disc, r);
@@ -81,6 +81,7 @@
 /* regalloc flags */
 
 #define REG_NOFREE 0x00000001 /* don't free                     */
+#define REG_NODFA 0x00000002  /* backtrack, no lazy dfa          */
 
 /* regsub flags */
 
@@ -175,6 +176,12 @@ typedef struct regstat_s {
     regflags_t re_info;  /* REG_* info                  */
 } regstat_t;
 
+typedef struct regcachestat_s {
+    int hits;   /* regcache() lookups found        */
+    int misses; /* regcache() lookups compiled     */
+    int size;   /* max # cached re's               */
+} regcachestat_t;
+
 struct regex_s {
     size_t re_nsub;           /* number of subexpressions       */
     struct reglib_s *re_info; /* library private info           */
@@ -199,6 +206,7 @@ extern int regrexec(const regex_t *, const char *, size_t, size_t, regmatch_t *,
                     void *, regrecord_t);
 extern regstat_t *regstat(const regex_t *);
 extern regex_t *regcache(const char *, regflags_t, int *);
+extern regcachestat_t *regcachestat(void);
 extern int regsubflags(regex_t *, const char *, char **, int, const regflags_t *, int *,
                        regflags_t *);
 extern void regsubfree(regex_t *);
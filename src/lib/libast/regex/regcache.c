@@ -22,6 +22,9 @@
 /*
  * regcomp() regex_t cache
  * at&t research
+ *
+ * entries are hashed on (pattern, reflags) and evicted
+ * least recently used first
  */
 #include "config_ast.h"  // IWYU pragma: keep
 
@@ -32,44 +35,113 @@
 #include "ast.h"
 #include "ast_regex.h"
 
-#define CACHE 8  /* default # cached re's       */
+#define CACHE 32 /* default # cached re's       */
 #define ROUND 64 /* pattern buffer size round   */
 
-typedef unsigned long Key_t;
-
 typedef struct Cache_s {
+    struct Cache_s *link; /* hash chain                  */
+    struct Cache_s *prev; /* lru list, most recent first */
+    struct Cache_s *next;
     char *pattern;
     regex_t re;
-    unsigned long serial;
+    unsigned int hash;
     regflags_t reflags;
     int keep;
     int size;
 } Cache_t;
 
 typedef struct State_s {
-    unsigned int size;
-    unsigned long serial;
+    unsigned int size;  /* max # cached re's           */
+    unsigned int count; /* # allocated entries         */
+    unsigned int mask;  /* hash table size - 1         */
     char *locale;
-    Cache_t **cache;
+    Cache_t **hash;
+    Cache_t lru; /* lru list head               */
+    regcachestat_t stat;
 } State_t;
 
 static State_t matchstate;
 
+/*
+ * hash pattern and reflags
+ */
+
+static_fn unsigned int regex_hashcache(const char *pattern, regflags_t reflags) {
+    unsigned int h = (unsigned int)reflags;
+
+    while (*pattern) h = h * 31 + *(unsigned char *)pattern++;
+    return h;
+}
+
+/*
+ * move cp to the front of the lru list
+ */
+
+static_fn void regex_usecache(Cache_t *cp) {
+    if (cp->prev) {
+        cp->prev->next = cp->next;
+        cp->next->prev = cp->prev;
+    }
+    cp->prev = &matchstate.lru;
+    cp->next = matchstate.lru.next;
+    cp->next->prev = cp;
+    matchstate.lru.next = cp;
+}
+
+/*
+ * drop cp from the hash table and free its re
+ */
+
+static_fn void regex_dropcache(Cache_t *cp) {
+    Cache_t **pp;
+
+    if (cp->keep) {
+        for (pp = &matchstate.hash[cp->hash & matchstate.mask]; *pp != cp; pp = &(*pp)->link) {
+            ;
+        }
+        *pp = cp->link;
+        cp->keep = 0;
+        regfree(&cp->re);
+    }
+}
+
 /*
  * flush the cache
  */
 
 static_fn void regex_flushcache(void) {
-    int i;
+    Cache_t *cp;
 
-    for (i = matchstate.size; i--;) {
-        if (matchstate.cache[i] && matchstate.cache[i]->keep) {
-            matchstate.cache[i]->keep = 0;
-            regfree(&matchstate.cache[i]->re);
-        }
+    for (cp = matchstate.lru.next; cp != &matchstate.lru; cp = cp->next) regex_dropcache(cp);
+}
+
+/*
+ * flush the cache and size it and its hash table for n re's
+ */
+
+static_fn int regex_sizecache(unsigned int n) {
+    Cache_t **hash;
+    unsigned int m;
+
+    regex_flushcache();
+    for (m = 16; m < 2 * n; m <<= 1) {
+        ;
     }
+    if (!(hash = calloc(m, sizeof(Cache_t *)))) return 1;
+    free(matchstate.hash);
+    matchstate.hash = hash;
+    matchstate.mask = m - 1;
+    matchstate.size = n;
+    matchstate.stat.size = n;
+    return 0;
 }
 
+/*
+ * return the cache statistics
+ */
+
+regcachestat_t *regcachestat(void) { return &matchstate.stat; }
+
 /*
  * return regcomp() compiled re for pattern and reflags
  */
@@ -78,34 +150,26 @@ regex_t *regcache(const char *pattern, regflags_t reflags, int *status) {
     Cache_t *cp;
     int i;
     char *s;
-    int empty;
-    int unused;
-    int old;
-    Key_t key;
+    unsigned int h;
 
     /*
      * 0 pattern flushes the cache and reflags>0 extends cache
      */
 
     if (!pattern) {
-        regex_flushcache();
+        if (!matchstate.lru.next) matchstate.lru.next = matchstate.lru.prev = &matchstate.lru;
         i = 0;
         if (reflags > matchstate.size) {
-            matchstate.cache = realloc(matchstate.cache, reflags * sizeof(Cache_t *));
-            if (matchstate.cache) {
-                matchstate.size = reflags;
-            } else {
-                matchstate.size = 0;
-                i = 1;
-            }
+            i = regex_sizecache(reflags);
+        } else {
+            regex_flushcache();
         }
         if (status) *status = i;
         return NULL;
     }
-    if (!matchstate.cache) {
-        matchstate.cache = calloc(1, CACHE * sizeof(Cache_t *));
-        if (!matchstate.cache) return NULL;
-        matchstate.size = CACHE;
+    if (!matchstate.hash) {
+        matchstate.lru.next = matchstate.lru.prev = &matchstate.lru;
+        if (regex_sizecache(CACHE)) return NULL;
     }
 
     /*
@@ -123,63 +187,52 @@ regex_t *regcache(const char *pattern, regflags_t reflags, int *status) {
      * check if the pattern is in the cache
      */
 
-    for (i = 0; i < sizeof(key) && pattern[i]; i++) ((char *)&key)[i] = pattern[i];
-    for (; i < sizeof(key); i++) ((char *)&key)[i] = 0;
-    empty = unused = -1;
-    old = 0;
-    for (i = matchstate.size; i--;) {
-        if (!matchstate.cache[i]) {
-            empty = i;
-        } else if (!matchstate.cache[i]->keep) {
-            unused = i;
-        } else if (*(Key_t *)matchstate.cache[i]->pattern == key &&
-                   !strcmp(matchstate.cache[i]->pattern, pattern) &&
-                   matchstate.cache[i]->reflags == reflags) {
-            break;
-        } else if (!matchstate.cache[old] ||
-                   matchstate.cache[old]->serial > matchstate.cache[i]->serial) {
-            old = i;
+    h = regex_hashcache(pattern, reflags);
+    for (cp = matchstate.hash[h & matchstate.mask]; cp; cp = cp->link) {
+        if (cp->hash == h && cp->reflags == reflags && !strcmp(cp->pattern, pattern)) {
+            matchstate.stat.hits++;
+            regex_usecache(cp);
+            if (status) *status = 0;
+            return &cp->re;
         }
     }
-    if (i < 0) {
-        if (unused < 0) {
-            if (empty < 0) {
-                unused = old;
-            } else {
-                unused = empty;
-            }
-        }
-        if (!(cp = matchstate.cache[unused]) &&
-            !(cp = matchstate.cache[unused] = calloc(1, sizeof(Cache_t)))) {
+    matchstate.stat.misses++;
+
+    /*
+     * reuse the least recently used entry if the cache is full
+     */
+
+    if (matchstate.count < matchstate.size) {
+        if (!(cp = calloc(1, sizeof(Cache_t)))) {
             if (status) *status = REG_ESPACE;
             return NULL;
         }
-        if (cp->keep) {
-            cp->keep = 0;
-            regfree(&cp->re);
-        }
-        if ((i = strlen(pattern) + 1) > cp->size) {
-            cp->size = roundof(i, ROUND);
-            cp->pattern = realloc(cp->pattern, cp->size);
-            if (!cp->pattern) {
-                if (status) *status = REG_ESPACE;
-                return NULL;
-            }
-        }
-        strcpy(cp->pattern, pattern);
-        while (++i < sizeof(Key_t)) cp->pattern[i] = 0;
-        pattern = (const char *)cp->pattern;
-        i = regcomp(&cp->re, pattern, reflags);
-        if (i) {
-            if (status) *status = i;
+        matchstate.count++;
+    } else {
+        cp = matchstate.lru.prev;
+        regex_dropcache(cp);
+    }
+    regex_usecache(cp);
+    if ((i = strlen(pattern) + 1) > cp->size) {
+        i = roundof(i, ROUND);
+        if (!(s = realloc(cp->pattern, i))) {
+            if (status) *status = REG_ESPACE;
             return NULL;
         }
-        cp->keep = 1;
-        cp->reflags = reflags;
-    } else {
-        cp = matchstate.cache[i];
+        cp->pattern = s;
+        cp->size = i;
+    }
+    strcpy(cp->pattern, pattern);
+    i = regcomp(&cp->re, cp->pattern, reflags);
+    if (i) {
+        if (status) *status = i;
+        return NULL;
     }
-    cp->serial = ++matchstate.serial;
+    cp->keep = 1;
+    cp->reflags = reflags;
+    cp->hash = h;
+    cp->link = matchstate.hash[h & matchstate.mask];
+    matchstate.hash[h & matchstate.mask] = cp;
     if (status) *status = 0;
     return &cp->re;
 }
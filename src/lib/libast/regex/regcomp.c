@@ -3122,6 +3122,7 @@ again:
     p->re_info->flags = env.flags & REG_COMP;
     p->re_info->min = env.stats.m;
     p->re_info->nsub = env.stats.p + env.stats.u;
+    regdfacomp(p->re_info);
     return 0;
 
 bad:
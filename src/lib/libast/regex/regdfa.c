@@ -0,0 +1,899 @@
+/***********************************************************************
+ *                                                                      *
+ *               This software is part of the ast package               *
+ *          Copyright (c) 1985-2013 AT&T Intellectual Property          *
+ *                      and is licensed under the                       *
+ *                 Eclipse Public License, Version 1.0                  *
+ *                    by AT&T Intellectual Property                     *
+ *                                                                      *
+ *                A copy of the License is available at                 *
+ *          http://www.eclipse.org/org/documents/epl-v10.html           *
+ *         (with md5 checksum b35adb5213ca9657e911e9befb180842)         *
+ *                                                                      *
+ *              Information and Software Systems Research               *
+ *                            AT&T Research                             *
+ *                           Florham Park NJ                            *
+ *                                                                      *
+ *               Glenn Fowler <glenn.s.fowler@gmail.com>                *
+ *                    David Korn <dgkorn@gmail.com>                     *
+ *                     Phong Vo <phongvo@gmail.com>                     *
+ *                                                                      *
+ ***********************************************************************/
+/*
+ * posix regex lazy dfa
+ *
+ * expressions without backreferences, conjunction, negation, lookaround
+ * or word boundaries are also compiled to a Thompson nfa; its subset
+ * states are built on demand and kept in a bounded cache so that
+ * regnexec() can decide match/no-match, and find the leftmost-longest
+ * match when there are no subexpressions, in time linear in the subject
+ * instead of backtracking
+ *
+ * the start of the leftmost match is found by running a second dfa for
+ * the reversed expression backwards from the end of the subject
+ */
+#include "config_ast.h"  // IWYU pragma: keep
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "ast.h"
+#include "ast_regex.h"
+#include "reglib.h"
+
+#define DFA_INST_MAX 4096         /* larger nfas are left to the backtracker       */
+#define DFA_WORK_MAX (4 * DFA_INST_MAX) /* node compilations, bounds empty repetitions */
+#define DFA_POOL_MIN (16 * 1024)  /* initial state cache size                      */
+#define DFA_POOL_MAX (256 * 1024) /* state cache size bound                        */
+#define DFA_HASH 256              /* state cache hash buckets                      */
+
+#define DFA_SET 0   /* consume one char in set                   */
+#define DFA_SPLIT 1 /* continue at both x and y                  */
+#define DFA_BOL 2   /* ^                                         */
+#define DFA_EOL 3   /* $                                         */
+#define DFA_MATCH 4 /* match ends here                           */
+
+#define DFA_ATBEG 0x01  /* state: subject beginning, ^ matches       */
+#define DFA_PREVNL 0x02 /* state: previous char is \n                */
+#define DFA_SEARCH 0x04 /* state: start pc is implied at each char   */
+
+#define DFA_ACCEPT 0x01   /* match ends here if next char is not \n    */
+#define DFA_ACCEPTNL 0x02 /* match ends here if next char is \n        */
+
+#define CTX_BOL 0x01   /* every ^ matches                           */
+#define CTX_BOLNL 0x02 /* REG_NEWLINE ^ matches                     */
+#define CTX_EOL 0x04   /* every $ matches                           */
+#define CTX_EOLNL 0x08 /* REG_NEWLINE $ matches                     */
+
+#define DFA_DEAD (&regdfa_dead) /* no match possible from here       */
+#define DFA_FAIL (&regdfa_fail) /* subject not handled, backtrack    */
+
+typedef struct Dfainst_s {
+    unsigned char op; /* DFA_* opcode                      */
+    unsigned char nl; /* REG_NEWLINE DFA_BOL or DFA_EOL    */
+    int x;            /* next pc                           */
+    int y;            /* DFA_SPLIT alternate pc            */
+    Set_t set;        /* DFA_SET chars                     */
+} Dfainst_t;
+
+typedef struct Dfastate_s {
+    struct Dfastate_s *link;   /* hash chain                        */
+    unsigned int hash;         /* hash of flags and pc              */
+    unsigned char flags;       /* DFA_ATBEG|DFA_PREVNL|DFA_SEARCH   */
+    unsigned char accept;      /* DFA_ACCEPT|DFA_ACCEPTNL           */
+    int npc;                   /* number of kernel pcs              */
+    int *pc;                   /* sorted kernel pcs                 */
+    struct Dfastate_s *next[]; /* transitions by char class, 0 if not built */
+} Dfastate_t;
+
+struct Dfa_s {
+    regdisc_t *disc;             /* allocation discipline             */
+    Dfainst_t *inst;             /* the nfa                           */
+    int ninst;                   /* number of nfa instructions        */
+    int minst;                   /* allocated nfa instructions        */
+    int start;                   /* nfa start pc                      */
+    int work;                    /* node compilations so far          */
+    int choices;                 /* alternations and variable repetitions */
+    Rex_t *bm;                   /* leading REX_BM prefilter          */
+    int nclass;                  /* number of char classes            */
+    unsigned char cls[UCHAR_MAX + 1]; /* char to class map           */
+    bool anchored;               /* match must start at subject beginning */
+    bool longest;                /* leftmost-longest match positions ok */
+    bool eolnl;                  /* nfa has a REG_NEWLINE DFA_EOL     */
+    bool wide;                   /* utf-8 locale, ascii subjects only */
+    bool reverse;                /* nfa matches the reversed expression */
+    bool norev;                  /* the reversed expression has no nfa */
+    Rex_t *rex;                  /* expression after the prefilter    */
+    struct Dfa_s *rev;           /* dfa for the reversed expression   */
+    uint32_t serial;             /* ast.locale.serial at compile time */
+    int *stack;                  /* closure stack                     */
+    int *list;                   /* closure list                      */
+    int *kern;                   /* next state kernel                 */
+    unsigned int *mark;          /* closure marks                     */
+    unsigned int gen;            /* current closure mark              */
+    char *pool;                  /* state cache                       */
+    size_t size;                 /* state cache size                  */
+    size_t used;                 /* state cache bytes in use          */
+    unsigned int flushes;        /* number of state cache flushes     */
+    Dfastate_t **hash;           /* state cache hash table            */
+    Dfastate_t *begin[(DFA_ATBEG | DFA_PREVNL | DFA_SEARCH) + 1]; /* start states by flags */
+};
+
+static Dfastate_t regdfa_dead;
+static Dfastate_t regdfa_fail;
+
+static uint32_t regdfa_coll_serial = UINT_MAX;
+static bool regdfa_coll_simple;
+
+//
+// Return true if no multi-char collating element can be matched by a bracket expression in the
+// current locale. regcollmatch() only extends an element when appending an alpha char leaves the
+// mbxfrm() size unchanged, so if no pair of alpha chars does that each bracket expression matches
+// exactly one char and can be tabulated per char.
+//
+static_fn bool regdfa_collsimple(int max) {
+    int a;
+    int b;
+    size_t n;
+    unsigned char key[3];
+    Ckey_t elt;
+
+    if (regdfa_coll_serial == ast.locale.serial) return regdfa_coll_simple;
+    regdfa_coll_serial = ast.locale.serial;
+    regdfa_coll_simple = true;
+    for (a = 1; a <= max; a++) {
+        if (!isalpha(a)) continue;
+        key[0] = a;
+        key[1] = 0;
+        n = mbxfrm(elt, key, COLL_KEY_MAX);
+        for (b = 1; b <= max; b++) {
+            if (!isalpha(b)) continue;
+            key[1] = b;
+            key[2] = 0;
+            if (mbxfrm(elt, key, COLL_KEY_MAX) == n) {
+                regdfa_coll_simple = false;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//
+// Append an nfa instruction and return its pc, -1 if the nfa is too big.
+//
+static_fn int regdfa_emit(Dfa_t *d, int op, int x, int y) {
+    Dfainst_t *ip;
+    int n;
+
+    if (d->ninst >= d->minst) {
+        if (d->ninst >= DFA_INST_MAX) return -1;
+        n = d->minst ? 2 * d->minst : 64;
+        if (n > DFA_INST_MAX) n = DFA_INST_MAX;
+        if (!(ip = regalloc(d->disc, d->inst, n * sizeof(Dfainst_t)))) return -1;
+        d->inst = ip;
+        d->minst = n;
+    }
+    ip = &d->inst[n = d->ninst++];
+    memset(ip, 0, sizeof(*ip));
+    ip->op = op;
+    ip->x = x;
+    ip->y = y;
+    return n;
+}
+
+//
+// Add the chars that map to c to set.
+//
+static_fn void regdfa_char(Set_t *set, int c, unsigned char *map) {
+    int i;
+
+    if (!map) {
+        setadd(set, c);
+    } else {
+        for (i = 0; i <= UCHAR_MAX; i++) {
+            if (map[i] == c) setadd(set, i);
+        }
+    }
+}
+
+//
+// Compile lo..hi repetitions of a single char set followed by pc k.
+//
+static_fn int regdfa_repset(Dfa_t *d, Set_t *set, int lo, int hi, int k) {
+    int i;
+    int b;
+    int l;
+
+    if (lo < 0 || lo > hi || lo > DFA_INST_MAX || (hi != RE_DUP_INF && hi > DFA_INST_MAX)) {
+        return -1;
+    }
+    if (lo != hi) d->choices++;
+    if (hi == RE_DUP_INF) {
+        if ((l = regdfa_emit(d, DFA_SPLIT, 0, k)) < 0) return -1;
+        if ((b = regdfa_emit(d, DFA_SET, l, 0)) < 0) return -1;
+        d->inst[b].set = *set;
+        d->inst[l].x = b;
+        k = l;
+    } else {
+        for (i = lo; i < hi; i++) {
+            if ((b = regdfa_emit(d, DFA_SET, k, 0)) < 0) return -1;
+            d->inst[b].set = *set;
+            if ((k = regdfa_emit(d, DFA_SPLIT, b, k)) < 0) return -1;
+        }
+    }
+    for (i = 0; i < lo; i++) {
+        if ((b = regdfa_emit(d, DFA_SET, k, 0)) < 0) return -1;
+        d->inst[b].set = *set;
+        k = b;
+    }
+    return k;
+}
+
+static_fn int regdfa_list(Dfa_t *, Env_t *, Rex_t *, int);
+
+//
+// Compile the trie sibling list x followed by pc k.
+//
+static_fn int regdfa_trie(Dfa_t *d, Rex_t *rex, Trie_node_t *x, int k) {
+    int r = -1;
+    int a;
+    int b;
+
+    for (; x; x = x->sib) {
+        if (x->son) {
+            if ((a = regdfa_trie(d, rex, x->son, k)) < 0) return -1;
+            if (x->end && (a = regdfa_emit(d, DFA_SPLIT, a, k)) < 0) return -1;
+        } else if (x->end) {
+            a = k;
+        } else {
+            continue;
+        }
+        if ((b = regdfa_emit(d, DFA_SET, a, 0)) < 0) return -1;
+        regdfa_char(&d->inst[b].set, x->c, rex->map);
+        if (r >= 0 && (b = regdfa_emit(d, DFA_SPLIT, b, r)) < 0) return -1;
+        r = b;
+    }
+    return r;
+}
+
+//
+// A trie word from its first char up to the current node, linked from the last char back.
+//
+typedef struct Dfapath_s {
+    struct Dfapath_s *up;
+    Trie_node_t *x;
+} Dfapath_t;
+
+//
+// Compile the chars of the trie word path read backwards, that is its first char last, followed
+// by pc k.
+//
+static_fn int regdfa_revword(Dfa_t *d, Rex_t *rex, Dfapath_t *path, int k) {
+    int b;
+
+    if (!path) return k;
+    if ((k = regdfa_revword(d, rex, path->up, k)) < 0) return -1;
+    if ((b = regdfa_emit(d, DFA_SET, k, 0)) < 0) return -1;
+    regdfa_char(&d->inst[b].set, path->x->c, rex->map);
+    return b;
+}
+
+//
+// Compile every word of the trie sibling list x below path, each read backwards, as alternatives
+// followed by pc k.
+//
+static_fn int regdfa_revtrie(Dfa_t *d, Rex_t *rex, Trie_node_t *x, Dfapath_t *up, int k) {
+    Dfapath_t path;
+    int r = -1;
+    int b;
+
+    path.up = up;
+    for (; x; x = x->sib) {
+        path.x = x;
+        if (x->end) {
+            if ((b = regdfa_revword(d, rex, &path, k)) < 0) return -1;
+            if (r >= 0 && (b = regdfa_emit(d, DFA_SPLIT, b, r)) < 0) return -1;
+            r = b;
+        }
+        if (x->son) {
+            if ((b = regdfa_revtrie(d, rex, x->son, &path, k)) < 0) return -1;
+            if (r >= 0 && (b = regdfa_emit(d, DFA_SPLIT, b, r)) < 0) return -1;
+            r = b;
+        }
+    }
+    return r;
+}
+
+//
+// Compile the single node rex followed by pc k, -1 if rex has no nfa equivalent.
+//
+static_fn int regdfa_node(Dfa_t *d, Env_t *env, Rex_t *rex, int k) {
+    Set_t set;
+    unsigned char *s;
+    unsigned char *t;
+    unsigned char buf[2];
+    int i;
+    int a;
+    int b;
+    int max;
+
+    if (++d->work > DFA_WORK_MAX) return -1;
+    if (rex->flags & REG_MINIMAL) d->longest = false;
+    max = d->wide ? 0x7f : UCHAR_MAX;
+    switch (rex->type) {
+        case REX_NULL:
+            return k;
+        case REX_BEG:
+        case REX_END:
+            // Read backwards ^ looks at the char that is consumed next, as $ does forwards.
+            if ((rex->type == REX_BEG) == d->reverse) {
+                if ((b = regdfa_emit(d, DFA_EOL, k, 0)) < 0) return -1;
+                if ((d->inst[b].nl = (rex->flags & REG_NEWLINE) != 0)) d->eolnl = true;
+            } else {
+                if ((b = regdfa_emit(d, DFA_BOL, k, 0)) < 0) return -1;
+                d->inst[b].nl = (rex->flags & REG_NEWLINE) != 0;
+            }
+            return b;
+        case REX_KMP:
+        case REX_STRING:
+            if (d->wide && rex->map) return -1;
+            s = rex->re.string.base;
+            t = s + rex->re.string.size;
+            while (t > s) {
+                if ((b = regdfa_emit(d, DFA_SET, k, 0)) < 0) return -1;
+                regdfa_char(&d->inst[b].set, d->reverse ? *s++ : *--t, rex->map);
+                k = b;
+            }
+            return k;
+        case REX_ONECHAR:
+            if (d->wide && rex->map) return -1;
+            memset(&set, 0, sizeof(set));
+            regdfa_char(&set, rex->re.onechar, rex->map);
+            return regdfa_repset(d, &set, rex->lo, rex->hi, k);
+        case REX_DOT:
+            memset(&set, ~0, sizeof(set));
+            if (rex->explicit >= 0) setclr(&set, rex->explicit);
+            return regdfa_repset(d, &set, rex->lo, rex->hi, k);
+        case REX_CLASS:
+            return regdfa_repset(d, rex->re.charclass, rex->lo, rex->hi, k);
+        case REX_COLL_CLASS:
+            if (!regdfa_collsimple(max)) return -1;
+            memset(&set, 0, sizeof(set));
+            for (i = 0; i <= max; i++) {
+                buf[0] = i;
+                buf[1] = 0;
+                if (regcollmatch(env, rex, buf, buf + 1, &t) && t == buf + 1) setadd(&set, i);
+            }
+            return regdfa_repset(d, &set, rex->lo, rex->hi, k);
+        case REX_ALT:
+            if (!rex->re.group.expr.binary.right) return -1;
+            d->choices++;
+            if ((a = regdfa_list(d, env, rex->re.group.expr.binary.left, k)) < 0) return -1;
+            if ((b = regdfa_list(d, env, rex->re.group.expr.binary.right, k)) < 0) return -1;
+            return regdfa_emit(d, DFA_SPLIT, a, b);
+        case REX_GROUP:
+            return regdfa_list(d, env, rex->re.group.expr.rex, k);
+        case REX_REP:
+            if (rex->lo < 0 || rex->lo > rex->hi || rex->lo > DFA_INST_MAX ||
+                (rex->hi != RE_DUP_INF && rex->hi > DFA_INST_MAX)) {
+                return -1;
+            }
+            if (rex->lo != rex->hi) d->choices++;
+            if (rex->hi == RE_DUP_INF) {
+                if ((a = regdfa_emit(d, DFA_SPLIT, 0, k)) < 0) return -1;
+                if ((b = regdfa_list(d, env, rex->re.group.expr.rex, a)) < 0) return -1;
+                d->inst[a].x = b;
+                k = a;
+            } else {
+                for (i = rex->lo; i < rex->hi; i++) {
+                    if ((b = regdfa_list(d, env, rex->re.group.expr.rex, k)) < 0) return -1;
+                    if ((k = regdfa_emit(d, DFA_SPLIT, b, k)) < 0) return -1;
+                }
+            }
+            for (i = 0; i < rex->lo; i++) {
+                if ((k = regdfa_list(d, env, rex->re.group.expr.rex, k)) < 0) return -1;
+            }
+            return k;
+        case REX_TRIE:
+            d->choices++;
+            a = -1;
+            for (i = 0; i <= UCHAR_MAX; i++) {
+                if (!rex->re.trie.root[i]) continue;
+                if (d->reverse) {
+                    b = regdfa_revtrie(d, rex, rex->re.trie.root[i], NULL, k);
+                } else {
+                    b = regdfa_trie(d, rex, rex->re.trie.root[i], k);
+                }
+                if (b < 0) return -1;
+                if (a >= 0 && (b = regdfa_emit(d, DFA_SPLIT, b, a)) < 0) return -1;
+                a = b;
+            }
+            return a;
+    }
+    return -1;
+}
+
+//
+// Compile the node list rex followed by pc k. The reversed list is compiled from its first node,
+// which is then matched last.
+//
+static_fn int regdfa_list(Dfa_t *d, Env_t *env, Rex_t *rex, int k) {
+    if (!rex) return k;
+    if (d->reverse) {
+        if ((k = regdfa_node(d, env, rex, k)) < 0) return -1;
+        return regdfa_list(d, env, rex->next, k);
+    }
+    if ((k = regdfa_list(d, env, rex->next, k)) < 0) return -1;
+    return regdfa_node(d, env, rex, k);
+}
+
+//
+// Partition the chars into classes that no DFA_SET distinguishes. \n is always a class of its
+// own because it also drives the REG_NEWLINE ^ and $ context, and in wide mode every non-ascii
+// char shares one class that sends the subject back to the backtracker.
+//
+static_fn void regdfa_classes(Dfa_t *d) {
+    short remap[2 * (UCHAR_MAX + 1)];
+    Set_t *set;
+    Set_t *prev = NULL;
+    int c;
+    int i;
+    int n;
+
+    memset(d->cls, 0, sizeof(d->cls));
+    d->cls['\n'] = 1;
+    n = 2;
+    if (d->wide) {
+        for (c = 0x80; c <= UCHAR_MAX; c++) d->cls[c] = n;
+        n++;
+    }
+    for (i = 0; i < d->ninst; i++) {
+        if (d->inst[i].op != DFA_SET) continue;
+        set = &d->inst[i].set;
+        if (d->wide) memset(&set->bits[0x80 / CHAR_BIT], 0, sizeof(set->bits) / 2);
+        if (prev && !memcmp(prev, set, sizeof(*set))) continue;
+        prev = set;
+        memset(remap, ~0, sizeof(remap));
+        n = 0;
+        for (c = 0; c <= UCHAR_MAX; c++) {
+            int k = 2 * d->cls[c] + (settst(set, c) != 0);
+            if (remap[k] < 0) remap[k] = n++;
+            d->cls[c] = remap[k];
+        }
+    }
+    d->nclass = n;
+}
+
+//
+// Partition the chars of the compiled nfa of d into classes and allocate its closure space.
+//
+static_fn bool regdfa_init(Dfa_t *d) {
+    int m;
+
+    regdfa_classes(d);
+    m = d->ninst;
+    if (!(d->stack = regalloc(d->disc, 0, 3 * m * sizeof(int))) ||
+        !(d->mark = regalloc(d->disc, 0, m * sizeof(unsigned int)))) {
+        return false;
+    }
+    d->list = d->stack + m;
+    d->kern = d->list + m;
+    memset(d->mark, 0, m * sizeof(unsigned int));
+    return true;
+}
+
+//
+// Build the nfa for env. If env has no nfa equivalent, or is anchored with at most one choice
+// point so that backtracking is already linear, then env->dfa stays 0 and regnexec() always
+// backtracks.
+//
+void regdfacomp(Env_t *env) {
+    Dfa_t *d;
+    Rex_t *e;
+    int m;
+
+    if ((env->disc->re_flags & REG_NODFA) || (env->flags & REG_FIRST) || env->leading >= 0 ||
+        (mbwide() && !ast.locale.is_utf8)) {
+        return;
+    }
+    if (!(e = env->rex)) return;
+    if (!(d = regalloc(env->disc, 0, sizeof(Dfa_t)))) return;
+    memset(d, 0, sizeof(*d));
+    if (e->type == REX_BM) {
+        d->bm = e;
+        e = e->next;
+    }
+    d->disc = env->disc;
+    d->wide = mbwide();
+    d->serial = ast.locale.serial;
+    d->anchored = env->once && e && e->type != REX_KMP;
+    d->longest = !(env->done.flags & REG_MINIMAL);
+    if ((m = regdfa_emit(d, DFA_MATCH, 0, 0)) < 0 || (d->start = regdfa_list(d, env, e, m)) < 0) {
+        regdfafree(d);
+        return;
+    }
+    if (d->anchored) d->bm = NULL;
+    if (d->anchored && d->choices <= 1) {
+        regdfafree(d);
+        return;
+    }
+    d->rex = e;
+    if (!regdfa_init(d)) {
+        regdfafree(d);
+        return;
+    }
+    env->dfa = d;
+}
+
+//
+// Build the dfa for the reversed expression of d, 0 if there is none. The reversed nfa reads the
+// subject from its end, so its ^ and $ trade places.
+//
+static_fn Dfa_t *regdfa_reverse(Env_t *env, Dfa_t *d) {
+    Dfa_t *r;
+    int m;
+
+    if (d->rev || d->norev) return d->rev;
+    d->norev = true;
+    if (!(r = regalloc(d->disc, 0, sizeof(Dfa_t)))) return NULL;
+    memset(r, 0, sizeof(*r));
+    r->disc = d->disc;
+    r->wide = d->wide;
+    r->serial = d->serial;
+    r->reverse = true;
+    r->longest = true;
+    if ((m = regdfa_emit(r, DFA_MATCH, 0, 0)) < 0 ||
+        (r->start = regdfa_list(r, env, d->rex, m)) < 0 || !regdfa_init(r)) {
+        regdfafree(r);
+        return NULL;
+    }
+    d->norev = false;
+    return d->rev = r;
+}
+
+void regdfafree(Dfa_t *d) {
+    if (d->rev) regdfafree(d->rev);
+    if (d->pool) (void)regalloc(d->disc, d->pool, 0);
+    if (d->mark) (void)regalloc(d->disc, d->mark, 0);
+    if (d->stack) (void)regalloc(d->disc, d->stack, 0);
+    if (d->inst) (void)regalloc(d->disc, d->inst, 0);
+    (void)regalloc(d->disc, d, 0);
+}
+
+//
+// Compute in d->list the DFA_SET and DFA_MATCH pcs reachable from the n pcs in pc under the
+// ^ and $ context ctx and return their number.
+//
+static_fn int regdfa_closure(Dfa_t *d, const int *pc, int n, int ctx) {
+    Dfainst_t *ip;
+    int sp = 0;
+    int m = 0;
+    int i;
+    int p;
+
+    if (!++d->gen) {
+        memset(d->mark, 0, d->ninst * sizeof(unsigned int));
+        d->gen = 1;
+    }
+    for (i = n; i-- > 0;) {
+        if (d->mark[p = pc[i]] != d->gen) {
+            d->mark[p] = d->gen;
+            d->stack[sp++] = p;
+        }
+    }
+    while (sp > 0) {
+        ip = &d->inst[p = d->stack[--sp]];
+        switch (ip->op) {
+            case DFA_SET:
+            case DFA_MATCH:
+                d->list[m++] = p;
+                continue;
+            case DFA_SPLIT:
+                if (d->mark[ip->y] != d->gen) {
+                    d->mark[ip->y] = d->gen;
+                    d->stack[sp++] = ip->y;
+                }
+                break;
+            case DFA_BOL:
+                if (!((ctx & CTX_BOL) || (ip->nl && (ctx & CTX_BOLNL)))) continue;
+                break;
+            case DFA_EOL:
+                if (!((ctx & CTX_EOL) || (ip->nl && (ctx & CTX_EOLNL)))) continue;
+                break;
+        }
+        if (d->mark[ip->x] != d->gen) {
+            d->mark[ip->x] = d->gen;
+            d->stack[sp++] = ip->x;
+        }
+    }
+    return m;
+}
+
+//
+// Return true if the closure of kernel pc under ctx contains the match pc.
+//
+static_fn bool regdfa_accept(Dfa_t *d, const int *pc, int n, int ctx) {
+    int i;
+
+    n = regdfa_closure(d, pc, n, ctx);
+    for (i = 0; i < n; i++) {
+        if (d->inst[d->list[i]].op == DFA_MATCH) return true;
+    }
+    return false;
+}
+
+//
+// Empty the state cache, growing it if it is still below its bound, so that a state of size
+// bytes fits. Pointers to existing states are invalid after this.
+//
+static_fn bool regdfa_flush(Dfa_t *d, size_t size) {
+    size_t n;
+    char *p;
+
+    n = d->size;
+    if (!n) {
+        n = DFA_POOL_MIN;
+    } else if (n < DFA_POOL_MAX) {
+        n *= 2;
+    }
+    while (n < DFA_POOL_MAX && n < DFA_HASH * sizeof(Dfastate_t *) + size) n *= 2;
+    if (n < DFA_HASH * sizeof(Dfastate_t *) + size) return false;
+    if (n != d->size) {
+        if (!(p = regalloc(d->disc, 0, n))) {
+            if (!d->pool) return false;
+        } else {
+            if (d->pool) (void)regalloc(d->disc, d->pool, 0);
+            d->pool = p;
+            d->size = n;
+        }
+    }
+    d->hash = (Dfastate_t **)d->pool;
+    memset(d->hash, 0, DFA_HASH * sizeof(Dfastate_t *));
+    d->used = DFA_HASH * sizeof(Dfastate_t *);
+    memset(d->begin, 0, sizeof(d->begin));
+    d->flushes++;
+    return true;
+}
+
+//
+// Return the state for flags and the sorted kernel pc, 0 if out of space.
+//
+static_fn Dfastate_t *regdfa_state(Dfa_t *d, int flags, const int *pc, int n) {
+    Dfastate_t *s;
+    unsigned int h;
+    size_t z;
+    int ctx;
+    int i;
+
+    h = flags;
+    for (i = 0; i < n; i++) h = h * 31 + pc[i];
+    if (d->pool) {
+        for (s = d->hash[h % DFA_HASH]; s; s = s->link) {
+            if (s->hash == h && s->flags == flags && s->npc == n &&
+                !memcmp(s->pc, pc, n * sizeof(int))) {
+                return s;
+            }
+        }
+    }
+    z = roundof(sizeof(Dfastate_t) + d->nclass * sizeof(Dfastate_t *) + n * sizeof(int),
+                sizeof(Dfastate_t *));
+    if ((!d->pool || d->used + z > d->size) && !regdfa_flush(d, z)) return NULL;
+    s = (Dfastate_t *)(d->pool + d->used);
+    d->used += z;
+    memset(s, 0, sizeof(Dfastate_t) + d->nclass * sizeof(Dfastate_t *));
+    s->hash = h;
+    s->flags = flags;
+    s->npc = n;
+    s->pc = (int *)&s->next[d->nclass];
+    memcpy(s->pc, pc, n * sizeof(int));
+    ctx = ((flags & DFA_ATBEG) ? CTX_BOL : 0) | ((flags & DFA_PREVNL) ? CTX_BOLNL : 0);
+    if (regdfa_accept(d, pc, n, ctx)) s->accept |= DFA_ACCEPT;
+    if (regdfa_accept(d, pc, n, ctx | CTX_EOLNL)) s->accept |= DFA_ACCEPTNL;
+    s->link = d->hash[h % DFA_HASH];
+    d->hash[h % DFA_HASH] = s;
+    return s;
+}
+
+static_fn int regdfa_cmp(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+//
+// Build the transition from s on char c, 0 if out of space.
+//
+static_fn Dfastate_t *regdfa_next(Dfa_t *d, Dfastate_t *s, int c) {
+    Dfastate_t *t;
+    Dfainst_t *ip;
+    unsigned int flushes;
+    int ctx;
+    int i;
+    int j;
+    int n;
+
+    if (d->wide && c >= 0x80) {
+        t = DFA_FAIL;
+    } else {
+        ctx = ((s->flags & DFA_ATBEG) ? CTX_BOL : 0) | ((s->flags & DFA_PREVNL) ? CTX_BOLNL : 0) |
+              (c == '\n' ? CTX_EOLNL : 0);
+        n = regdfa_closure(d, s->pc, s->npc, ctx);
+        for (i = j = 0; i < n; i++) {
+            ip = &d->inst[d->list[i]];
+            if (ip->op == DFA_SET && settst(&ip->set, c)) d->kern[j++] = ip->x;
+        }
+        if (s->flags & DFA_SEARCH) d->kern[j++] = d->start;
+        if (!j) {
+            t = DFA_DEAD;
+        } else {
+            qsort(d->kern, j, sizeof(int), regdfa_cmp);
+            for (i = n = 1; i < j; i++) {
+                if (d->kern[i] != d->kern[n - 1]) d->kern[n++] = d->kern[i];
+            }
+            flushes = d->flushes;
+            t = regdfa_state(d, (c == '\n' ? DFA_PREVNL : 0) | (s->flags & DFA_SEARCH), d->kern,
+                             n);
+            if (!t || flushes != d->flushes) return t;
+        }
+    }
+    s->next[d->cls[c]] = t;
+    return t;
+}
+
+//
+// Run the dfa on subject beg[0..len) starting at offset i and return the offset of the first
+// (first!=0) or last match end, -1 if there is no match, or -2 if the backtracker must decide.
+//
+static_fn ssize_t regdfa_run(Dfa_t *d, const unsigned char *beg, size_t len, size_t i,
+                             bool search, bool first, regflags_t flags) {
+    Dfastate_t *s;
+    Dfastate_t *t;
+    ssize_t last = -1;
+    int ctx;
+    int c;
+    int f;
+
+    f = search ? DFA_SEARCH : 0;
+    if (i == 0) {
+        if (!(flags & REG_NOTBOL)) f |= DFA_ATBEG;
+    } else if (beg[i - 1] == '\n') {
+        f |= DFA_PREVNL;
+    }
+    if (!(s = d->begin[f])) {
+        if (!(s = regdfa_state(d, f, &d->start, 1))) return -2;
+        d->begin[f] = s;
+    }
+    for (; i < len; i++) {
+        c = beg[i];
+        if (s->accept & (c == '\n' ? DFA_ACCEPTNL : DFA_ACCEPT)) {
+            last = i;
+            if (first) return last;
+        }
+        if (!(t = s->next[d->cls[c]]) && !(t = regdfa_next(d, s, c))) return -2;
+        if (t == DFA_DEAD) return last;
+        if (t == DFA_FAIL) return -2;
+        s = t;
+    }
+    ctx = ((s->flags & DFA_ATBEG) ? CTX_BOL : 0) | ((s->flags & DFA_PREVNL) ? CTX_BOLNL : 0);
+    if (!(flags & REG_NOTEOL)) ctx |= CTX_EOL;
+    if (d->eolnl && beg[len] == '\n') ctx |= CTX_EOLNL;
+    if (regdfa_accept(d, s->pc, s->npc, ctx)) last = len;
+    return last;
+}
+
+//
+// Run the reversed dfa r backwards from the end of subject beg[0..len) down to offset lo, starting
+// a match at each char, and return the lowest offset where a match of the expression starts, -1
+// if there is none, or -2 if the backtracker must decide.
+//
+static_fn ssize_t regdfa_back(Dfa_t *r, const unsigned char *beg, size_t len, size_t lo,
+                              bool eolnl, regflags_t flags) {
+    Dfastate_t *s;
+    Dfastate_t *t;
+    ssize_t first = -1;
+    size_t i;
+    int ctx;
+    int c;
+    int f;
+
+    if (lo > len) return -1;
+    // Read backwards the subject starts where it ends, and ^ and $ trade places.
+    f = DFA_SEARCH;
+    if (!(flags & REG_NOTEOL)) f |= DFA_ATBEG;
+    if (eolnl && beg[len] == '\n') f |= DFA_PREVNL;
+    if (!(s = r->begin[f])) {
+        if (!(s = regdfa_state(r, f, &r->start, 1))) return -2;
+        r->begin[f] = s;
+    }
+    for (i = len; i > 0; i--) {
+        c = beg[i - 1];
+        if (s->accept & (c == '\n' ? DFA_ACCEPTNL : DFA_ACCEPT)) first = i;
+        if (i == lo) return first;
+        if (!(t = s->next[r->cls[c]]) && !(t = regdfa_next(r, s, c))) return -2;
+        if (t == DFA_DEAD) return first;
+        if (t == DFA_FAIL) return -2;
+        s = t;
+    }
+    ctx = ((s->flags & DFA_ATBEG) ? CTX_BOL : 0) | ((s->flags & DFA_PREVNL) ? CTX_BOLNL : 0);
+    if (!(flags & REG_NOTBOL)) ctx |= CTX_EOL;
+    if (regdfa_accept(r, s->pc, s->npc, ctx)) first = 0;
+    return first;
+}
+
+//
+// Return the first subject offset where the REX_BM prefilter e allows a match to start, -1 if
+// there is none. This is the regnexec() REX_BM scan without the backtracking at each candidate.
+//
+static_fn ssize_t regdfa_bm(Rex_t *e, const unsigned char *buf, size_t len) {
+    size_t index = e->re.bm.left + e->re.bm.size;
+    size_t mid;
+    size_t *skip = e->re.bm.skip;
+    size_t *fail = e->re.bm.fail;
+    Bm_mask_t **mask = e->re.bm.mask;
+    Bm_mask_t m;
+    ssize_t n;
+
+    if (len < e->re.bm.right) return -1;
+    mid = len - e->re.bm.right;
+    for (;;) {
+        while (index < mid) index += skip[buf[index]];
+        if (index < HIT) return -1;
+        index -= HIT;
+        n = e->re.bm.size - 1;
+        m = mask[n][buf[index]];
+        do {
+            if (!n--) {
+                if (e->re.bm.back < 0) return 0;
+                return index < (size_t)e->re.bm.back ? 0 : index - e->re.bm.back;
+            }
+            m &= mask[n][buf[--index]];
+        } while (m);
+        if ((index += fail[n + 1]) >= len) return -1;
+    }
+}
+
+//
+// regnexec() front end. Return -1 if the backtracker must be used for this match.
+//
+int regdfaexec(const regex_t *p, const char *s, size_t len, size_t nmatch, regmatch_t *match,
+               regflags_t flags) {
+    Env_t *env = p->re_info;
+    Dfa_t *d = env->dfa;
+    Dfa_t *r;
+    const unsigned char *beg = (const unsigned char *)s;
+    ssize_t b = 0;
+    ssize_t e;
+    ssize_t so;
+    ssize_t eo;
+    size_t i;
+
+    if (d->serial != ast.locale.serial || d->wide != mbwide()) return -1;
+    if (d->bm && (b = regdfa_bm(d->bm, beg, len)) < 0) return REG_NOMATCH;
+    if ((e = regdfa_run(d, beg, len, b, !d->anchored, true, flags)) < -1) return -1;
+    if (e < 0) return REG_NOMATCH;
+    if (env->flags & REG_NOSUB) return 0;
+    if (nmatch) {
+        if (!d->longest || env->nsub) return -1;
+        // A match usually starts where the prefilter points. Otherwise the reversed dfa finds the
+        // leftmost start, which is at most the end of the first match found.
+        so = b;
+        if ((eo = regdfa_run(d, beg, len, so, false, false, flags)) < -1) return -1;
+        if (eo < 0) {
+            if (d->anchored || !(r = regdfa_reverse(env, d))) return -1;
+            if ((so = regdfa_back(r, beg, len, b + 1, d->eolnl, flags)) < 0 || so > e) return -1;
+            if ((eo = regdfa_run(d, beg, len, so, false, false, flags)) < 0) return -1;
+        }
+        match[0].rm_so = so;
+        match[0].rm_eo = eo;
+        for (i = 1; i < nmatch; i++) match[i] = regstate.nomatch;
+    }
+    if ((env->flags & (REG_SHELL | REG_AUGMENTED)) == (REG_SHELL | REG_AUGMENTED)) {
+        ((regex_t *)p)->re_nsub = 0;
+    }
+    return 0;
+}
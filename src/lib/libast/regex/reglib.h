@@ -407,9 +407,12 @@ typedef struct Rex_s {
     } re;
 } Rex_t;
 
+typedef struct Dfa_s Dfa_t; /* lazy dfa, private to regdfa.c */
+
 typedef struct reglib_s /* library private regex_t info */
 {
     struct Rex_s *rex;                 /* compiled expression           */
+    Dfa_t *dfa;                        /* lazy dfa equivalent of rex    */
     regdisc_t *disc;                   /* REG_DISCIPLINE discipline     */
     const regex_t *regex;              /* from regexec                  */
     unsigned char *beg;                /* beginning of string           */
@@ -466,5 +469,9 @@ extern State_t regstate;
 extern regclass_t regclassfun(int);
 extern void regdrop(regdisc_t *, Rex_t *);
 extern int regfatal(regdisc_t *, int, const char *);
+extern int regcollmatch(Env_t *, Rex_t *, unsigned char *, unsigned char *, unsigned char **);
+extern void regdfacomp(Env_t *);
+extern int regdfaexec(const regex_t *, const char *, size_t, size_t, regmatch_t *, regflags_t);
+extern void regdfafree(Dfa_t *);
 
 #endif  // _REGLIB_H
@@ -658,8 +658,7 @@ static_fn int collic(Celt_t *ce, char *key, char *nxt, int c, int x) {
     return collelt(ce, key, c, x);
 }
 
-static_fn int collmatch(Env_t *env, Rex_t *rex, unsigned char *s, unsigned char *e,
-                        unsigned char **p) {
+int regcollmatch(Env_t *env, Rex_t *rex, unsigned char *s, unsigned char *e, unsigned char **p) {
     unsigned char *t;
     wchar_t c;
     int z;
@@ -922,7 +921,7 @@ static_fn int regnexec_parse(Env_t *env, Rex_t *rex, Rex_t *cont, unsigned char
                         env->error = REG_ESPACE;
                         return BAD;
                     }
-                    for (i = 0; s < e && i < n && collmatch(env, rex, s, e, &t); i++) {
+                    for (i = 0; s < e && i < n && regcollmatch(env, rex, s, e, &t); i++) {
                         b[i] = t - s;
                         s = t;
                     }
@@ -945,7 +944,7 @@ static_fn int regnexec_parse(Env_t *env, Rex_t *rex, Rex_t *cont, unsigned char
                     stkpop(env->mst);
                 } else {
                     for (i = 0; i < m && s < e; i++, s = t) {
-                        if (!collmatch(env, rex, s, e, &t)) return r;
+                        if (!regcollmatch(env, rex, s, e, &t)) return r;
                     }
                     while (i++ <= n) {
                         switch (follow(env, rex, cont, s)) {
@@ -957,7 +956,7 @@ static_fn int regnexec_parse(Env_t *env, Rex_t *rex, Rex_t *cont, unsigned char
                             case GOOD:
                                 return BEST;
                         }
-                        if (s >= e || !collmatch(env, rex, s, e, &s)) break;
+                        if (s >= e || !regcollmatch(env, rex, s, e, &s)) break;
                     }
                 }
                 return r;
@@ -1730,6 +1729,11 @@ int regnexec(const regex_t *p, const char *s, size_t len, size_t nmatch, regmatc
                    sfprintf(sfstdout, "AHA#%04d REG_NOMATCH %d %d\n", __LINE__, len, env->min));
         return REG_NOMATCH;
     }
+    if (env->dfa && !(flags & (REG_ADVANCE | REG_LEFT)) &&
+        (k = regdfaexec(p, s, len, nmatch, match, flags)) >= 0) {
+        DEBUG_CODE(0x0080, sfprintf(sfstdout, "AHA#%04d dfa %d\n", __LINE__, k));
+        return k;
+    }
     env->regex = p;
     env->beg = (unsigned char *)s;
     env->end = env->beg + len;
@@ -1871,6 +1875,7 @@ void regfree(regex_t *p) {
         p->re_info = NULL;
         if (!(env->disc->re_flags & REG_NOFREE)) {
             regdrop(env->disc, env->rex);
+            if (env->dfa) regdfafree(env->dfa);
             if (env->pos) vecclose(env->pos);
             if (env->bestpos) vecclose(env->bestpos);
             if (env->mst) stkclose(env->mst);
@@ -809,6 +809,7 @@ extern int _sfpclose(Sfio_t *);
 extern int _sfexcept(Sfio_t *, int, ssize_t, Sfdisc_t *);
 extern Sfrsrv_t *_sfrsrv(Sfio_t *, ssize_t);
 extern int _sfsetpool(Sfio_t *);
+extern void _sfwrsync(void);
 extern char *_sfcvt(void *, char *, size_t, int, int *, int *, int *, int);
 extern char **_sfgetpath(char *);
 extern Mbstate_t *_sfmbstate(Sfio_t *);
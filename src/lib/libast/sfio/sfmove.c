@@ -21,10 +21,18 @@
  ***********************************************************************/
 #include "config_ast.h"  // IWYU pragma: keep
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#if _lib_sendfile
+#include <sys/sendfile.h>
+#endif
 
 #include "sfhdr.h"  // IWYU pragma: keep
 #include "sfio.h"
@@ -38,6 +46,124 @@
 */
 #define MAX_SSIZE ((ssize_t)((~((size_t)0)) >> 1))
 
+#if _lib_copy_file_range || _lib_splice || _lib_sendfile
+
+#define SF_ZCHUNK ((size_t)1 << 30) /* most asked of the kernel in one call        */
+
+#define SF_ZCOPY 1   /* copy_file_range(): both ends are regular files  */
+#define SF_ZSPLICE 2 /* splice(): one end is a pipe                     */
+#define SF_ZSEND 3   /* sendfile(): a regular file to anything else      */
+
+/*      A discipline that only handles exceptions does not see the data,
+**      so the kernel may move it on the stream's behalf.
+*/
+static_fn int _sfzdisc(Sfdisc_t *disc) {
+    for (; disc; disc = disc->disc) {
+        if (disc->readf || disc->writef || disc->seekf) return 0;
+    }
+    return 1;
+}
+
+/*      Decide whether the kernel can move data between the file descriptors
+**      of fr and fw without it passing through user space, and how.
+*/
+static_fn int _sfzmethod(Sfio_t *fr, Sfio_t *fw, Sfoff_t *size) {
+    struct stat rst, wst;
+
+    if (fr->file < 0 || fw->file < 0 || (fr->flags & SF_STRING) || (fw->flags & SF_STRING) ||
+        (fw->flags & SF_APPENDWR) || (fw->bits & SF_NULL) || fr->push || fw->push ||
+        !_sfzdisc(fr->disc) || !_sfzdisc(fw->disc)) {
+        return 0;
+    }
+    if (fstat(fr->file, &rst) < 0 || fstat(fw->file, &wst) < 0) return 0;
+    *size = S_ISREG(rst.st_mode) ? rst.st_size : -1;
+#if _lib_copy_file_range
+    if (S_ISREG(rst.st_mode) && S_ISREG(wst.st_mode)) return SF_ZCOPY;
+#endif
+#if _lib_splice
+    if (S_ISFIFO(rst.st_mode) || S_ISFIFO(wst.st_mode)) return SF_ZSPLICE;
+#endif
+#if _lib_sendfile
+    if (S_ISREG(rst.st_mode) && !S_ISDIR(wst.st_mode)) return SF_ZSEND;
+#endif
+    return 0;
+}
+
+/*      Move up to n bytes (all of them if n < 0) from fr to fw inside the kernel.
+**      Both streams must have empty buffers. Returns the amount moved; whatever
+**      is left, including the detection of end of file and the reporting of
+**      errors, is up to the buffered loop in sfmove().
+*/
+static_fn Sfoff_t _sfzmove(Sfio_t *fr, Sfio_t *fw, Sfoff_t n, int method, Sfoff_t size) {
+    Sfoff_t moved;
+    ssize_t r;
+    size_t w;
+    int oerrno = errno;
+
+    /* be at the physical location the buffered code would use */
+    if (fr->extent >= 0 && (fr->flags & SF_SHARE)) {
+        if (!(fr->flags & SF_PUBLIC)) {
+            fr->here = SFSK(fr, fr->here, SEEK_SET, fr->disc);
+        } else {
+            fr->here = SFSK(fr, (Sfoff_t)0, SEEK_CUR, fr->disc);
+        }
+    }
+    if (fw->extent >= 0 && (fw->flags & SF_SHARE) && !(fw->flags & SF_PUBLIC)) {
+        fw->here = SFSK(fw, fw->here, SEEK_SET, fw->disc);
+    }
+    if (fr->extent < 0) _sfwrsync(); /* as sfrd() does before waiting on a pipe */
+
+    for (moved = 0; n != 0; moved += r) {
+        /* a regular file is only trusted up to its size: files under /proc claim none */
+        if (size >= 0) {
+            if (fr->here >= size) break;
+            w = (size - fr->here) > SF_ZCHUNK ? SF_ZCHUNK : (size_t)(size - fr->here);
+        } else {
+            w = SF_ZCHUNK;
+        }
+        if (n > 0 && (Sfoff_t)w > n) w = (size_t)n;
+
+        switch (method) {  //!OCLINT(MissingDefaultStatement)
+#if _lib_copy_file_range
+            case SF_ZCOPY:
+                r = copy_file_range(fr->file, NULL, fw->file, NULL, w, 0);
+                break;
+#endif
+#if _lib_splice
+            case SF_ZSPLICE:
+                r = splice(fr->file, NULL, fw->file, NULL, w, SPLICE_F_MOVE);
+                break;
+#endif
+#if _lib_sendfile
+            case SF_ZSEND:
+                r = sendfile(fw->file, fr->file, NULL, w);
+                break;
+#endif
+            default:
+                r = -1;
+                break;
+        }
+        if (r <= 0) break; /* EINVAL, EXDEV and the like: the buffered loop takes over */
+
+        fr->here += r;
+        if (fr->extent >= 0 && fr->here > fr->extent) fr->extent = fr->here;
+        if (fw->flags & SF_PUBLIC && fw->extent >= 0) {
+            fw->here = SFSK(fw, (Sfoff_t)0, SEEK_CUR, fw->disc);
+        } else {
+            fw->here += r;
+        }
+        if (fw->extent >= 0 && fw->here > fw->extent) fw->extent = fw->here;
+        fw->bits &= ~SF_HOLE;
+        if (n > 0) n -= r;
+    }
+
+    errno = oerrno;
+    if (moved > 0 && !(fr->bits & SF_MMAP)) fr->next = fr->endb = fr->endr = fr->data;
+    return moved;
+}
+
+#endif
+
 Sfoff_t sfmove(Sfio_t *fr, Sfio_t *fw, Sfoff_t n, int rc) {
     uchar *cp, *next;
     ssize_t r, w;
@@ -46,6 +172,10 @@ Sfoff_t sfmove(Sfio_t *fr, Sfio_t *fw, Sfoff_t n, int rc) {
     Sfoff_t n_move, sk, cur;
     uchar *rbuf = NULL;
     ssize_t rsize = 0;
+#if _lib_copy_file_range || _lib_splice || _lib_sendfile
+    int zmethod = -1;
+    Sfoff_t zsize = -1;
+#endif
     SFMTXDECL(fr)   // declare a shadow stream variable for from stream
     SFMTXDECL2(fw)  // declare a shadow stream variable for to stream
 
@@ -95,6 +225,21 @@ Sfoff_t sfmove(Sfio_t *fr, Sfio_t *fw, Sfoff_t n, int rc) {
             /* else: stream unstacking may happen below */
         }
 
+#if _lib_copy_file_range || _lib_splice || _lib_sendfile
+        /* with nothing buffered on either side, let the kernel move the data */
+        if (fw && zmethod != 0 && fr->endb <= fr->next && !(fr->rsrv && fr->rsrv->slen < 0)) {
+            if (zmethod < 0) zmethod = _sfzmethod(fr, fw, &zsize);
+            if (zmethod > 0 &&
+                (fw->next == fw->data || (SFFLSBUF(fw, -1) >= 0 && fw->next == fw->data))) {
+                sk = _sfzmove(fr, fw, n, zmethod, zsize);
+                n_move += sk;
+                if (n > 0) n -= sk;
+            }
+            zmethod = 0;
+            if (n == 0) goto again;
+        }
+#endif
+
         /* about to move all, set map to a large amount */
         if (n < 0 && (fr->bits & SF_MMAP) && !(fr->bits & SF_MVSIZE)) {
             SFMVSET(fr)
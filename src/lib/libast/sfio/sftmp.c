@@ -26,6 +26,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if _lib_memfd_create
+#include <sys/mman.h>
+#endif
+
 #include "sfhdr.h"  // IWYU pragma: keep
 #include "sfio.h"
 #include "vthread.h"
@@ -34,7 +38,8 @@
 
 /*      Create a temporary stream for read/write.
 **      The stream is originally created as a memory-resident stream.
-**      When this memory is exceeded, a real temp file will be created.
+**      When this memory is exceeded, a real temp file will be created,
+**      an anonymous memory file where the system supports memfd_create().
 **      The temp file creation sequence is somewhat convoluted so that
 **      pool/stack/discipline will work correctly.
 **
@@ -135,9 +140,14 @@ static_fn int _rmtmp(Sfio_t *f, char *file) {
 
 static_fn int _tmpfd(Sfio_t *f) {
     int fd;
-    char *file = ast_temp_file(NULL, "sf", &fd, 0);
+    char *file;
 
-    if (!file) return -1;
+#if _lib_memfd_create
+    /* an anonymous memory file has no name to remove and never touches $TMPDIR,
+       so command substitution output and here documents stay in memory */
+    if ((fd = memfd_create("sftmp", 0)) >= 0) return fd;
+#endif
+    if (!(file = ast_temp_file(NULL, "sf", &fd, 0))) return -1;
     _rmtmp(f, file);
     free(file);
     return fd;
@@ -0,0 +1,154 @@
+#include "config_ast.h"  // IWYU pragma: keep
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ast.h"
+#include "ast_regex.h"
+
+//
+// Compare regexec() times for the backtracker (REG_NODFA discipline) and the lazy dfa on
+// pathological and realistic inputs, and time regcache() lookups. Run with
+// `meson test --benchmark`.
+//
+
+#define SH (REG_SHELL | REG_AUGMENTED | REG_LEFT | REG_RIGHT)
+
+struct Bench {
+    const char *name;    // subject description
+    const char *pattern;
+    regflags_t flags;
+    int nmatch;          // 0 for a boolean match
+    char *(*subject)(int);
+    int size;            // subject size argument
+    int loops;           // regexec() calls per timing
+};
+
+static char *repeat(int n) {
+    char *s = malloc(n + 1);
+
+    memset(s, 'a', n);
+    s[n] = 0;
+    return s;
+}
+
+static char *text(int n) {
+    static const char *words[] = {"alpha", "beta",  "gamma", "delta=42", "key=value",
+                                  "x1234", "omega", "path/to/file.c", "#comment"};
+    char *s = malloc(n + 32);
+    int i = 0;
+    unsigned long seed = 1;
+
+    while (i < n) {
+        seed = seed * 1103515245 + 12345;
+        i += sprintf(s + i, "%s%c", words[(seed >> 16) % elementsof(words)],
+                     (seed >> 8) % 8 ? ' ' : '\n');
+    }
+    s[n] = 0;
+    return s;
+}
+
+static char *name(int n) {
+    UNUSED(n);
+    return strdup("src/lib/libast/regex/regnexec.c");
+}
+
+static const struct Bench benches[] = {
+    {"24 a's", "(a|aa)*b", REG_EXTENDED, 0, repeat, 24, 1},
+    {"20 a's", "(a*)*b", REG_EXTENDED, 0, repeat, 20, 1},
+    {"24 a's", "+(a|aa)b", SH, 0, repeat, 24, 1},
+    {"8KiB of a's", "a*b", REG_EXTENDED, 0, repeat, 8192, 4},
+    {"1MiB text", "[0-9]+z", REG_EXTENDED, 0, text, 1 << 20, 4},
+    {"1MiB text", "(foo|bar|baz)[0-9]", REG_EXTENDED, 0, text, 1 << 20, 4},
+    {"1MiB text", "^#.*x$", REG_EXTENDED | REG_NEWLINE, 0, text, 1 << 20, 4},
+    {"1MiB text", "key=[a-z]+ [a-z]+ x", REG_EXTENDED, 1, text, 1 << 20, 4},
+    {"file name", "*.c", SH, 0, name, 0, 200000},
+    {"file name", "*/+([a-z]).[ch]", SH, 0, name, 0, 200000},
+    {"file name", "*lib*regex*", SH, 0, name, 0, 200000},
+    {NULL, NULL, 0, 0, NULL, 0, 0}};
+
+static double elapsed(regex_t *re, const char *s, const struct Bench *bp, int *rc) {
+    struct timespec t0, t1;
+    regmatch_t match[1];
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < bp->loops; i++) *rc = regexec(re, s, bp->nmatch, match, 0);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+}
+
+//
+// A shell case statement with more glob arms than the cache used to hold, as strmatch() sees it.
+//
+static void bench_regcache(void) {
+    static const char *arms[] = {"*.c",  "*.h",   "*.cc",  "*.cpp", "*.hpp",  "*.o",
+                                 "*.a",  "*.so",  "*.py",  "*.sh",  "*.ksh",  "*.md",
+                                 "*.1",  "*.3",   "*.json", "*.xml", "*.html", "*.css",
+                                 "*.js", "*.ts",  "*.go",  "*.rs",  "*.java", "f1?.txt"};
+    struct timespec t0, t1;
+    regcachestat_t *st = regcachestat();
+    char subject[32];
+    int hits = st->hits;
+    int misses = st->misses;
+    int calls = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < 20000; i++) {
+        snprintf(subject, sizeof(subject), "f%d.txt", i % 30);
+        for (size_t j = 0; j < elementsof(arms); j++) {
+            calls++;
+            if (strmatch(subject, arms[j])) break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("\nstrmatch() %zu case arms: %d calls %.2f ms, regcache() size %d hits %d misses %d\n",
+           elementsof(arms), calls,
+           (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6, st->size,
+           st->hits - hits, st->misses - misses);
+}
+
+int main(int argc, char **argv) {
+    UNUSED(argc);
+    UNUSED(argv);
+    regdisc_t disc;
+    regex_t dfa;
+    regex_t bt;
+    double tb;
+    double td;
+    int rb = 0;
+    int rd = 0;
+    int status = 0;
+
+    ast_setlocale(LC_ALL, "C");
+    memset(&disc, 0, sizeof(disc));
+    disc.re_version = REG_VERSION;
+    disc.re_flags = REG_NODFA;
+    printf("%-22s %-14s %8s %12s %12s %8s\n", "pattern", "subject", "calls", "backtrack ms",
+           "dfa ms", "speedup");
+    for (const struct Bench *bp = benches; bp->pattern; bp++) {
+        char *s = bp->subject(bp->size);
+
+        bt.re_disc = &disc;
+        if (regcomp(&dfa, bp->pattern, bp->flags) ||
+            regcomp(&bt, bp->pattern, bp->flags | REG_DISCIPLINE)) {
+            fprintf(stderr, "%s: regcomp failed\n", bp->pattern);
+            return 1;
+        }
+        tb = elapsed(&bt, s, bp, &rb);
+        td = elapsed(&dfa, s, bp, &rd);
+        if (rb != rd) {
+            fprintf(stderr, "%s: backtrack %d dfa %d\n", bp->pattern, rb, rd);
+            status = 1;
+        }
+        printf("%-22s %-14s %8d %12.2f %12.2f %7.1fx\n", bp->pattern, bp->name, bp->loops, tb, td,
+               td > 0 ? tb / td : 0);
+        regfree(&dfa);
+        regfree(&bt);
+        free(s);
+    }
+    bench_regcache();
+    return status;
+}
@@ -0,0 +1,69 @@
+#include "config_ast.h"  // IWYU pragma: keep
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ast.h"
+#include "ast_regex.h"
+#include "terror.h"
+
+static regex_t *lookup(int i, regflags_t flags) {
+    char pattern[32];
+    regex_t *re;
+
+    snprintf(pattern, sizeof(pattern), "p%d*", i);
+    if (!(re = regcache(pattern, flags, NULL))) {
+        terror("regcache('%s', 0x%x) failed", pattern, flags);
+    }
+    return re;
+}
+
+tmain() {
+    UNUSED(argc);
+    UNUSED(argv);
+    regcachestat_t *st = regcachestat();
+    regex_t *re;
+    int hits;
+    int misses;
+    int i;
+
+    re = lookup(0, REG_SHELL);
+    if (st->size < 8) terror("initial cache size %d < 8", st->size);
+    if (st->hits != 0 || st->misses != 1) {
+        terror("hits %d misses %d, expected 0 1", st->hits, st->misses);
+    }
+    if (lookup(0, REG_SHELL) != re) terror("cached re not reused");
+    if (lookup(0, REG_SHELL | REG_ICASE) == re) terror("re reused for different flags");
+    if (st->hits != 1 || st->misses != 2) {
+        terror("hits %d misses %d, expected 1 2", st->hits, st->misses);
+    }
+    if (regexec(re, "p0xyz", 0, NULL, 0) != 0) terror("cached re does not match");
+
+    // Fill the cache while keeping p0 recently used; p0 must survive and the oldest entry must not.
+    for (i = 1; i < st->size; i++) {
+        lookup(i, REG_SHELL);
+        lookup(0, REG_SHELL);
+    }
+    hits = st->hits;
+    misses = st->misses;
+    lookup(0, REG_SHELL);
+    if (st->hits != hits + 1) terror("least recently used entry evicted instead of the oldest");
+    lookup(0, REG_SHELL | REG_ICASE);
+    if (st->misses != misses + 1) terror("oldest entry not evicted");
+
+    // Extending the cache flushes it.
+    regcache(NULL, 2 * st->size, &i);
+    if (i) terror("regcache(NULL, %d) failed", 2 * st->size);
+    misses = st->misses;
+    for (i = 0; i < st->size; i++) lookup(i, REG_SHELL);
+    for (i = 0; i < st->size; i++) lookup(i, REG_SHELL);
+    if (st->misses != misses + st->size) {
+        terror("%d misses filling a cache of %d", st->misses - misses, st->size);
+    }
+
+    // A bad pattern is reported and not cached.
+    if (regcache("[", REG_EXTENDED, &i) || !i) terror("regcache('[') should fail");
+    if (regcache("[", REG_EXTENDED, &i) || !i) terror("regcache('[') should fail again");
+
+    texit(0);
+}
@@ -0,0 +1,242 @@
+#include "config_ast.h"  // IWYU pragma: keep
+
+#include <locale.h>
+#include <string.h>
+
+#include "ast.h"
+#include "ast_regex.h"
+#include "terror.h"
+
+//
+// The lazy dfa must agree with the backtracker, which is still used when the discipline has
+// REG_NODFA, on every pattern/subject/flags combination it accepts.
+//
+
+struct Pattern {
+    const char *pattern;
+    regflags_t flags;
+};
+
+#define SH (REG_SHELL | REG_AUGMENTED | REG_LEFT | REG_RIGHT)
+#define SHMIN (REG_SHELL | REG_AUGMENTED | REG_MINIMAL)
+
+static const struct Pattern patterns[] = {
+    {"a", REG_EXTENDED},
+    {"ab*", REG_EXTENDED},
+    {"a|b", REG_EXTENDED},
+    {"(a|ab)(c|bcd)", REG_EXTENDED},
+    {"(a|aa)*b", REG_EXTENDED},
+    {"(a*)*b", REG_EXTENDED},
+    {"^a*$", REG_EXTENDED},
+    {"^a*$", REG_EXTENDED | REG_NEWLINE},
+    {"^$", REG_EXTENDED | REG_NEWLINE},
+    {"b$", REG_EXTENDED | REG_NEWLINE},
+    {"a.b", REG_EXTENDED},
+    {"a.b", REG_EXTENDED | REG_NEWLINE},
+    {"a.*b", REG_EXTENDED},
+    {"[ab]{2,3}", REG_EXTENDED},
+    {"[^a]+", REG_EXTENDED},
+    {"[^a\n]+", REG_EXTENDED | REG_NEWLINE},
+    {"x?ab{0,2}", REG_EXTENDED},
+    {"(ab|ba|aab|bba)+", REG_EXTENDED},
+    {"abc|abd|b", REG_EXTENDED},
+    {"A+B", REG_EXTENDED | REG_ICASE},
+    {"a*", REG_EXTENDED},
+    {"(a|b)*ab(a|b)*", REG_EXTENDED},
+    {"\\(a*\\)b", 0},
+    {"a\\{1,2\\}b", 0},
+    {"*a*", SH},
+    {"a*", SH},
+    {"*b", SH},
+    {"?a?", SH},
+    {"+(a|aa)b", SH},
+    {"@(ab|ba)*", SH},
+    {"[!a]*", SH},
+    {"[a-b]?", SH},
+    {"*(a)b*(b)", SH},
+    {"a*", SHMIN},
+    {"*(a|b)", SHMIN},
+    {"b", SHMIN},
+    {"[ab]", REG_SHELL | REG_AUGMENTED},
+    {"[[:alpha:]]+", REG_EXTENDED},
+    {"(^|b)a", REG_EXTENDED | REG_NEWLINE},
+    {"a(b|$)", REG_EXTENDED | REG_NEWLINE},
+    {"[^b]*b", REG_EXTENDED},
+    {"a.*\xc3", REG_EXTENDED},
+    {"\xc3\xa9+", REG_EXTENDED},
+    {"*(?)b", SH},
+    {"*\xc3\xa9?", SH},
+    {"abcd|c", REG_EXTENDED},
+    {"a*c", REG_EXTENDED},
+    {"(ab|b)c", REG_EXTENDED},
+    {"b(a|c)*$", REG_EXTENDED},
+    {"b(a|c)*$", REG_EXTENDED | REG_NEWLINE},
+    {"(^|a)b*c", REG_EXTENDED | REG_NEWLINE},
+    {"ab|b|ca|Ac", REG_EXTENDED},
+    {"(b|ab)*c", REG_EXTENDED},
+    {NULL, 0}};
+
+static const regflags_t execflags[] = {0, REG_NOTBOL, REG_NOTEOL, REG_NOTBOL | REG_NOTEOL};
+
+static unsigned long seed = 1;
+
+static int rnd(int n) {
+    seed = seed * 1103515245 + 12345;
+    return (int)((seed >> 16) % n);
+}
+
+static void compare(regex_t *dfa, regex_t *bt, const struct Pattern *pp, const char *s) {
+    regmatch_t m[2][3];
+    size_t nsub[2];
+    int r[2];
+    size_t nmatch;
+    size_t i;
+    size_t e;
+
+    for (e = 0; e < elementsof(execflags); e++) {
+        for (nmatch = 0; nmatch <= 3; nmatch += 3) {
+            memset(m, 0, sizeof(m));
+            dfa->re_nsub = nsub[0] = bt->re_nsub;
+            r[0] = regexec(dfa, s, nmatch, m[0], execflags[e]);
+            r[1] = regexec(bt, s, nmatch, m[1], execflags[e]);
+            nsub[0] = dfa->re_nsub;
+            nsub[1] = bt->re_nsub;
+            if (r[0] != r[1]) {
+                terror("'%s' 0x%x '%s' 0x%x nmatch=%zu: dfa %d backtrack %d", pp->pattern,
+                       pp->flags, s, execflags[e], nmatch, r[0], r[1]);
+                continue;
+            }
+            if (r[0]) continue;
+            if (nsub[0] != nsub[1]) {
+                terror("'%s' 0x%x '%s': dfa re_nsub %zu backtrack %zu", pp->pattern, pp->flags, s,
+                       nsub[0], nsub[1]);
+            }
+            for (i = 0; i < nmatch && !(pp->flags & REG_NOSUB); i++) {
+                if (m[0][i].rm_so != m[1][i].rm_so || m[0][i].rm_eo != m[1][i].rm_eo) {
+                    terror("'%s' 0x%x '%s' 0x%x match[%zu]: dfa (%zd,%zd) backtrack (%zd,%zd)",
+                           pp->pattern, pp->flags, s, execflags[e], i, (ssize_t)m[0][i].rm_so,
+                           (ssize_t)m[0][i].rm_eo, (ssize_t)m[1][i].rm_so,
+                           (ssize_t)m[1][i].rm_eo);
+                }
+            }
+        }
+    }
+}
+
+static void test_agreement(void) {
+    static const char alphabet[] = "ab\nAc\xc3\xa9";
+    regdisc_t disc;
+    regex_t dfa;
+    regex_t bt;
+    char s[16];
+    int i;
+    int j;
+    int n;
+
+    memset(&disc, 0, sizeof(disc));
+    disc.re_version = REG_VERSION;
+    disc.re_flags = REG_NODFA;
+    for (const struct Pattern *pp = patterns; pp->pattern; pp++) {
+        if (regcomp(&dfa, pp->pattern, pp->flags)) {
+            terror("regcomp('%s', 0x%x) failed", pp->pattern, pp->flags);
+            continue;
+        }
+        bt.re_disc = &disc;
+        if (regcomp(&bt, pp->pattern, pp->flags | REG_DISCIPLINE)) {
+            terror("regcomp('%s', 0x%x|REG_DISCIPLINE) failed", pp->pattern, pp->flags);
+            regfree(&dfa);
+            continue;
+        }
+        // Every subject up to 4 bytes over a small alphabet, then random longer ones.
+        for (n = 0; n <= 4; n++) {
+            int total = 1;
+            for (i = 0; i < n; i++) total *= sizeof(alphabet) - 1;
+            for (j = 0; j < total; j++) {
+                int k = j;
+                for (i = 0; i < n; i++) {
+                    s[i] = alphabet[k % (sizeof(alphabet) - 1)];
+                    k /= sizeof(alphabet) - 1;
+                }
+                s[n] = 0;
+                compare(&dfa, &bt, pp, s);
+            }
+        }
+        for (j = 0; j < 200; j++) {
+            n = 5 + rnd(10);
+            for (i = 0; i < n; i++) s[i] = alphabet[rnd(sizeof(alphabet) - 1)];
+            s[n] = 0;
+            compare(&dfa, &bt, pp, s);
+        }
+        regfree(&dfa);
+        regfree(&bt);
+    }
+}
+
+//
+// These take exponential time to fail in the backtracker.
+//
+static void test_pathological(void) {
+    static const struct Pattern slow[] = {{"(a|aa)*b", REG_EXTENDED},
+                                          {"(a*)*b", REG_EXTENDED},
+                                          {"+(a|aa)b", SH},
+                                          {"*(*(a)*(a))b", SH},
+                                          {NULL, 0}};
+    char s[1024];
+    regex_t re;
+    regmatch_t m[1];
+
+    memset(s, 'a', sizeof(s) - 1);
+    s[sizeof(s) - 1] = 0;
+    for (const struct Pattern *pp = slow; pp->pattern; pp++) {
+        if (regcomp(&re, pp->pattern, pp->flags)) {
+            terror("regcomp('%s', 0x%x) failed", pp->pattern, pp->flags);
+            continue;
+        }
+        if (regexec(&re, s, 0, NULL, 0) != REG_NOMATCH) {
+            terror("'%s' should not match %zu a's", pp->pattern, strlen(s));
+        }
+        if (regexec(&re, s, 1, m, 0) != REG_NOMATCH) {
+            terror("'%s' should not match %zu a's with positions", pp->pattern, strlen(s));
+        }
+        regfree(&re);
+    }
+}
+
+//
+// The start of a match that begins past the first candidate is found in one backwards pass.
+//
+static void test_position(void) {
+    static char s[40003];
+    regex_t re;
+    regmatch_t m[1];
+    size_t n = sizeof(s) - 3;
+
+    memset(s, 'a', n);
+    s[n] = 'b';
+    s[n + 1] = 'c';
+    s[n + 2] = 0;
+    if (regcomp(&re, "a*c", REG_EXTENDED)) {
+        terror("regcomp('a*c') failed");
+        return;
+    }
+    if (regexec(&re, s, 1, m, 0)) {
+        terror("'a*c' should match %zu a's then bc", n);
+    } else if (m[0].rm_so != (ssize_t)n + 1 || m[0].rm_eo != (ssize_t)n + 2) {
+        terror("'a*c' matched (%zd,%zd) not (%zu,%zu)", (ssize_t)m[0].rm_so, (ssize_t)m[0].rm_eo,
+               n + 1, n + 2);
+    }
+    regfree(&re);
+}
+
+tmain() {
+    UNUSED(argc);
+    UNUSED(argv);
+
+    ast_setlocale(LC_ALL, "C");
+    test_agreement();
+    test_pathological();
+    test_position();
+    if (ast_setlocale(LC_ALL, "C.UTF-8")) test_agreement();
+
+    texit(0);
+}
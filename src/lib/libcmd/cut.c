@@ -95,6 +95,7 @@ typedef struct Delim_s {
 
 typedef struct Cut_s {
     int mb;
+    int simple;  // single byte delimiters that can be found with memchr()
     int eob;
     int cflag;
     int nosplit;
@@ -120,6 +121,16 @@ typedef struct Cut_s {
 #define SP_WORD 2
 #define SP_WIDE 3
 
+/*
+ * output gathered by cutsimple() for a single sfwrite()
+ */
+
+typedef struct Cutout_s {
+    Sfio_t *fp;
+    size_t len;
+    char buf[8 * BLOCK];
+} Cutout_t;
+
 /*
  * compare the first of an array of integers
  */
@@ -156,6 +167,9 @@ static Cut_t *cutinit(int mode, char *str, Delim_t *wdelim, Delim_t *ldelim, siz
     cut->sflag = (mode & C_SUPRESS) != 0;
     cut->nlflag = (mode & C_NONEWLINE) != 0;
     cut->reclen = reclen;
+    // UTF-8 never uses ASCII bytes inside a multibyte character.
+    cut->simple = wdelim->len == 1 && ldelim->len == 1 &&
+                  (!cut->mb || (ast.locale.is_utf8 && wdelim->chr < 0x80 && ldelim->chr < 0x80));
     lp = cut->list;
     for (;;) {
         switch (c = *cp++) {
@@ -519,6 +533,103 @@ failed:
     if (fdtmp) sfclose(fdtmp);
 }
 
+/*
+ * append <n> bytes at <s> to the output of cutsimple()
+ */
+
+static int cutput(Cutout_t *out, const void *s, size_t n) {
+    if (out->len + n > sizeof(out->buf)) {
+        if (out->len && sfwrite(out->fp, out->buf, out->len) < 0) return -1;
+        out->len = 0;
+        if (n >= sizeof(out->buf)) return sfwrite(out->fp, s, n) < 0 ? -1 : 0;
+    }
+    memcpy(out->buf + out->len, s, n);
+    out->len += n;
+    return 0;
+}
+
+/*
+ * cut the line of <len> bytes at <bp>, which ends with the line delimiter when <term> is set
+ * the field delimiters are found with memchr() instead of one byte at a time
+ */
+
+static int cutline(Cut_t *cut, Cutout_t *out, const char *bp, size_t len, int term) {
+    const char *cp = bp;
+    const char *ep = bp + len - term;
+    const char *fp;
+    const char *dp;
+    const int *lp = cut->list;
+    int d = cut->wdelim.chr;
+    int n;
+
+    for (;;) {
+        /* skip the fields between ranges */
+        if ((n = *lp++) == HUGE) break;
+        while (n-- > 0) {
+            if (!(dp = memchr(cp, d, ep - cp))) goto eol;
+            cp = dp + 1;
+        }
+        /* copy the range, with the delimiter in front unless it is the first */
+        fp = lp == cut->list + 1 ? cp : cp - 1;
+        if ((n = *lp++) != HUGE) {
+            while (n-- > 0) {
+                if (!(dp = memchr(cp, d, ep - cp))) break;
+                cp = dp + 1;
+            }
+            if (n < 0) {
+                if (cutput(out, fp, cp - 1 - fp)) return -1;
+                continue;
+            }
+        }
+        if (cut->sflag && cp == bp && !memchr(bp, d, ep - bp)) return 0;
+        return cutput(out, fp, bp + len - fp);
+    }
+    return term ? cutput(out, "\n", 1) : 0;
+eol:
+    /* no delimiter at all passes the line unless -s, otherwise the range is past the end */
+    if (cp > bp) return term ? cutput(out, "\n", 1) : 0;
+    if (cut->sflag || (!term && cut->list[0])) return 0;
+    return cutput(out, bp, len);
+}
+
+/*
+ * cutfields() for single byte delimiters
+ */
+
+static void cutsimple(Cut_t *cut, Sfio_t *fdin, Sfio_t *fdout) {
+    Cutout_t out;
+    char *bp;
+    char *cp;
+    char *ep;
+    char *dp;
+    int eob = cut->eob;
+    int r;
+
+    out.fp = fdout;
+    out.len = 0;
+    while ((bp = sfreserve(fdin, SF_UNBOUND, SF_LOCKR))) {
+        ep = bp + sfvalue(fdin);
+        for (cp = bp; (dp = memchr(cp, eob, ep - cp)); cp = dp + 1) {
+            if (cutline(cut, &out, cp, dp + 1 - cp, 1)) {
+                sfread(fdin, bp, 0);
+                return;
+            }
+        }
+        sfread(fdin, bp, cp - bp);
+        if (cp > bp) continue;
+        /* no line ends in the buffer */
+        if ((cp = sfgetr(fdin, eob, 0))) {
+            r = cutline(cut, &out, cp, sfvalue(fdin), 1);
+        } else if ((cp = sfgetr(fdin, eob, SF_LASTR))) {
+            r = cutline(cut, &out, cp, sfvalue(fdin), 0);
+        } else {
+            break;
+        }
+        if (r) return;
+    }
+    if (out.len) sfwrite(fdout, out.buf, out.len);
+}
+
 int b_cut(int argc, char **argv, Shbltin_t *context) {
     char *cp = NULL;
     Sfio_t *fp;
@@ -637,7 +748,9 @@ int b_cut(int argc, char **argv, Shbltin_t *context) {
             error(ERROR_system(0), "%s: cannot open", cp);
             continue;
         }
-        if (mode & C_FIELDS) {
+        if ((mode & C_FIELDS) && cut->simple) {
+            cutsimple(cut, fp, sfstdout);
+        } else if (mode & C_FIELDS) {
             cutfields(cut, fp, sfstdout);
         } else {
             cutcols(cut, fp, sfstdout);